@@ -0,0 +1,192 @@
+#include "ChunkStore.h"
+
+#include <cstdio>
+#include <fstream>
+#include <utility>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+/// <summary>
+/// Creates the store's directory if it doesn't already exist, and starts its worker thread
+/// </summary>
+/// <param name="asDirectory">Directory to keep chunk files in</param>
+/// <param name="aiChunkCountX">Width of the simulation in chunks, used to name each chunk's file after its position</param>
+ChunkStore::ChunkStore(const std::string& asDirectory, int aiChunkCountX)
+	: sDirectory(asDirectory), iChunkCountX(aiChunkCountX)
+{
+#ifdef _WIN32
+	_mkdir(sDirectory.c_str());
+#else
+	mkdir(sDirectory.c_str(), 0755);
+#endif
+
+	worker = std::thread([this]() { WorkerLoop(); });
+}
+
+/// <summary>
+/// Finishes every outstanding request, so no saves are lost, then joins the worker thread
+/// </summary>
+ChunkStore::~ChunkStore()
+{
+	{
+		std::lock_guard<std::mutex> lock(requestLock);
+		bShuttingDown = true;
+	}
+	requestAdded.notify_one();
+	worker.join();
+}
+
+/// <summary>
+/// Queues a chunk to be written to disk, replacing anything already stored for it
+/// </summary>
+void ChunkStore::Save(StoredChunk&& aChunk)
+{
+	{
+		std::lock_guard<std::mutex> lock(requestLock);
+		requests.push_back({ CHUNK_STORE_REQUEST::SAVE, std::move(aChunk) });
+	}
+	requestAdded.notify_one();
+}
+
+/// <summary>
+/// Queues a chunk to be read from disk. Once read, it is returned by CollectLoaded. Chunks with nothing stored are returned empty.
+/// </summary>
+void ChunkStore::Load(int aiChunkID)
+{
+	StoredChunk chunk;
+	chunk.iChunkID = aiChunkID;
+	{
+		std::lock_guard<std::mutex> lock(requestLock);
+		requests.push_back({ CHUNK_STORE_REQUEST::LOAD, std::move(chunk) });
+	}
+	requestAdded.notify_one();
+}
+
+/// <summary>
+/// Queues a chunk's file to be deleted
+/// </summary>
+void ChunkStore::Erase(int aiChunkID)
+{
+	StoredChunk chunk;
+	chunk.iChunkID = aiChunkID;
+	{
+		std::lock_guard<std::mutex> lock(requestLock);
+		requests.push_back({ CHUNK_STORE_REQUEST::ERASE, std::move(chunk) });
+	}
+	requestAdded.notify_one();
+}
+
+/// <summary>
+/// Reads a chunk from disk on the calling thread, once every request queued before it has been carried out. Chunks with nothing stored are returned empty.
+/// </summary>
+/// <remarks>Waits on the disk, so is only for when the whole store is needed at once, such as saving the simulation.</remarks>
+StoredChunk ChunkStore::LoadNow(int aiChunkID)
+{
+	{
+		std::unique_lock<std::mutex> lock(requestLock);
+		requestsFinished.wait(lock, [this]() { return requests.empty() && !bWorking; });
+	}
+	return LoadChunk(aiChunkID);
+}
+
+/// <summary>
+/// Moves every chunk that has finished loading since the last call into arLoaded. Never waits on the disk.
+/// </summary>
+void ChunkStore::CollectLoaded(std::vector<StoredChunk>& arLoaded)
+{
+	std::lock_guard<std::mutex> lock(requestLock);
+	for (StoredChunk& rChunk : loadedChunks)
+	{
+		arLoaded.push_back(std::move(rChunk));
+	}
+	loadedChunks.clear();
+}
+
+/// <summary>
+/// Main loop for the worker - sleeps until a request is queued, then carries it out. The lock is never held while accessing the disk.
+/// </summary>
+void ChunkStore::WorkerLoop()
+{
+	while (true)
+	{
+		Request request;
+		{
+			std::unique_lock<std::mutex> lock(requestLock);
+			requestAdded.wait(lock, [this]() { return bShuttingDown || !requests.empty(); });
+			if (requests.empty())
+			{
+				return;		// Only reached once shutting down, with every request finished
+			}
+			request = std::move(requests.front());
+			requests.pop_front();
+			bWorking = true;
+		}
+
+		switch (request.eType)
+		{
+		case CHUNK_STORE_REQUEST::SAVE:
+			SaveChunk(request.chunk);
+			break;
+		case CHUNK_STORE_REQUEST::LOAD:
+		{
+			StoredChunk loaded = LoadChunk(request.chunk.iChunkID);
+			std::lock_guard<std::mutex> lock(requestLock);
+			loadedChunks.push_back(std::move(loaded));
+			break;
+		}
+		case CHUNK_STORE_REQUEST::ERASE:
+			std::remove(QChunkPath(request.chunk.iChunkID).c_str());
+			break;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(requestLock);
+			bWorking = false;
+		}
+		requestsFinished.notify_all();
+	}
+}
+
+/// <summary>
+/// Writes a chunk to its file. Formatted the same as a simulation file, with a single particle per line.
+/// </summary>
+void ChunkStore::SaveChunk(const StoredChunk& arChunk)
+{
+	std::ofstream chunkFile(QChunkPath(arChunk.iChunkID));
+	for (const ParticleSnapshot& snap : arChunk.particles)
+	{
+		chunkFile << static_cast<int>(snap.tType) << "," << snap.x << "," << snap.y << "," << snap.iTemp << "\n";
+	}
+}
+
+/// <summary>
+/// Reads a chunk from its file
+/// </summary>
+StoredChunk ChunkStore::LoadChunk(int aiChunkID)
+{
+	StoredChunk chunk;
+	chunk.iChunkID = aiChunkID;
+
+	std::ifstream chunkFile(QChunkPath(aiChunkID));
+	int iType = 0;
+	ParticleSnapshot snap;
+	char cSeparator;
+	while (chunkFile >> iType >> cSeparator >> snap.x >> cSeparator >> snap.y >> cSeparator >> snap.iTemp)
+	{
+		snap.tType = static_cast<PARTICLE_TYPE>(iType);
+		chunk.particles.push_back(snap);
+	}
+	return chunk;
+}
+
+/// <summary>
+/// Returns the path of a chunk's file, named after the chunk's position
+/// </summary>
+std::string ChunkStore::QChunkPath(int aiChunkID)
+{
+	return sDirectory + "/Chunk_" + std::to_string(aiChunkID % iChunkCountX) + "_" + std::to_string(aiChunkID / iChunkCountX) + ".txt";
+}
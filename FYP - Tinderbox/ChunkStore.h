@@ -0,0 +1,68 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ParticleSimulation.h"
+
+/// <summary>
+/// The particles of a single chunk, as written to or read from a ChunkStore
+/// </summary>
+struct StoredChunk
+{
+	int iChunkID = 0;
+	std::vector<ParticleSnapshot> particles;
+};
+
+/// <summary>
+/// On-disk store for chunks paged out of a streaming simulation. Each chunk is kept in its own CSV formatted file.
+/// Every request is queued and carried out on a background thread, so callers never wait on the disk, apart from LoadNow.
+/// </summary>
+/// <remarks>Requests are carried out in the order they were made, so loading a chunk straight after saving it reads back what was saved.</remarks>
+class ChunkStore
+{
+public:
+	ChunkStore(const std::string& asDirectory, int aiChunkCountX);
+	~ChunkStore();
+
+	void Save(StoredChunk&& aChunk);
+	void Load(int aiChunkID);
+	void Erase(int aiChunkID);
+	StoredChunk LoadNow(int aiChunkID);
+	void CollectLoaded(std::vector<StoredChunk>& arLoaded);
+
+private:
+	enum class CHUNK_STORE_REQUEST : uint8_t
+	{
+		SAVE,
+		LOAD,
+		ERASE
+	};
+
+	struct Request
+	{
+		CHUNK_STORE_REQUEST eType;
+		StoredChunk chunk;
+	};
+
+	void WorkerLoop();
+	void SaveChunk(const StoredChunk& arChunk);
+	StoredChunk LoadChunk(int aiChunkID);
+	std::string QChunkPath(int aiChunkID);
+
+	std::string sDirectory;
+	int iChunkCountX = 0;
+
+	std::thread worker;
+	std::mutex requestLock;
+	std::condition_variable requestAdded;
+	std::condition_variable requestsFinished;
+	std::deque<Request> requests;
+	std::vector<StoredChunk> loadedChunks;
+	bool bShuttingDown = false;
+	bool bWorking = false;		// True while the worker is carrying out a request it has taken from the queue
+};
@@ -11,9 +11,23 @@ enum class PARTICLE_FIRE_STATE
 	EXTINGUISHED
 };
 
+/// <summary>
+/// Broad class of a particle, deciding how it moves. Each class has its own Particle subclass.
+/// </summary>
+enum class PARTICLE_CLASS : uint8_t
+{
+	POWDER,
+	LIQUID,
+	GAS,
+	SOLID,
+	COUNT
+};
+
 struct ParticleProperties
 {};
 
+class ParticleSimulation;
+
 class Particle
 {
 public:
@@ -25,29 +39,35 @@ public:
 		x = aiX;
 		y = aiY;
 	}
+	virtual ~Particle() = default;
 
 	// Overrides
 	virtual void	SetProperties(ParticleProperties apProperties) {}
-	virtual void	HandleMovement() {}
-	virtual void	HandleFireProperties() {}
+	virtual void	HandleMovement(ParticleSimulation&) {}
+	virtual void	HandleFireProperties(ParticleSimulation&) {}
 	virtual void	Ignite() {}
 	virtual void	ForceWake() { bResting = false; }
 	virtual bool	QHasLifetimeExpired() { return bExpired; }
+	virtual bool	QNeedsUpdate() { return !QResting(); }
 	virtual int		QIgnitionTemperature() { return -1; }
 	virtual int		QFuel() { return -1; }
 	virtual uint8_t QDeathParticleType() { return 0; }
+	virtual sf::Color QColor() { return sf::Color(); }
 
 	// Core
 	void		Extinguish()						{ if (QIsOnFire()) { eFireState = PARTICLE_FIRE_STATE::NONE; temperature *= 0.5f; } }
-	void		SetHasBeenUpdated(bool abNewVal)	{ bHasBeenUpdatedThisTick = abNewVal; }
+	void		SetLastUpdatedTick(uint32_t auiTick)	{ uiLastUpdatedTick = auiTick; }
+	void		SetCountedActive(bool abNewVal)		{ bCountedActive = abNewVal; }
 	void		IncreaseTemperature(int aiStep)		{ temperature += aiStep; }
 	void		ForceExpire()						{ bExpired = true; uiParticleType = 0; }
-	sf::Color	QColor()							{ return cColor; }
+	void		SetPosition(unsigned int aiX, unsigned int aiY)	{ x = aiX; y = aiY; }
 	int			QX()								{ return x; }
 	int			QY()								{ return y; }
-	bool		QHasBeenUpdatedThisTick()			{ return bHasBeenUpdatedThisTick; }
+	uint32_t	QLastUpdatedTick()					{ return uiLastUpdatedTick; }
+	bool		QCountedActive()					{ return bCountedActive; }
 	int			QID()								{ return iParticleID; }
 	uint8_t		QType()								{ return uiParticleType; }
+	PARTICLE_CLASS	QClass()						{ return eClass; }
 	bool		QResting()							{ return bResting && eFireState != PARTICLE_FIRE_STATE::BURNING; }
 	int			QTemperature()						{ return temperature; }
 	bool		QIsOnFire()							{ return eFireState == PARTICLE_FIRE_STATE::BURNING; }
@@ -55,11 +75,12 @@ public:
 protected:
 	int iParticleID;
 	uint8_t uiParticleType;
+	PARTICLE_CLASS eClass = PARTICLE_CLASS::COUNT;		// Set by each subclass. Unlike the type, kept once the particle expires.
 	bool bExpired = false;
 	bool bResting = false;
-	bool bHasBeenUpdatedThisTick = false;
+	uint32_t uiLastUpdatedTick = 0;		// Tick epoch this particle was last updated on
+	bool bCountedActive = false;		// Whether the owning simulation currently counts this particle as active
 	unsigned int x, y;
-	sf::Color cColor;
 	int temperature = 0;
 	PARTICLE_FIRE_STATE eFireState = PARTICLE_FIRE_STATE::NONE;
 };
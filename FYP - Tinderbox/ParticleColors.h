@@ -0,0 +1,36 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+
+#include <cstdint>
+#include <cstdlib>
+
+#define RANDOM_INT(MIN, MAX) \
+	rand() % (MAX - MIN + 1) + MIN
+
+#define RANDOM_BOOL \
+	RANDOM_INT(0, 100) > 50
+
+// Primitive Colours
+#define COLOR_GREY	sf::Color(150,	150,	150,	255)
+#define COLOR_PINK	sf::Color(197,	61,		227,	255)
+
+// Element colours. Packed as RGBA, so material tables holding them can be built at compile time - read with sf::Color(COLOR_X).
+#define PACK_COLOR(R, G, B, A) \
+	((static_cast<uint32_t>(R) << 24) | (static_cast<uint32_t>(G) << 16) | (static_cast<uint32_t>(B) << 8) | static_cast<uint32_t>(A))
+
+#define COLOR_WOOD		PACK_COLOR(82,	56,		33,		255)
+#define COLOR_METAL		PACK_COLOR(81,	86,		89,		255)
+#define COLOR_ROCK		PACK_COLOR(128,	134,	128,	255)
+#define COLOR_SAND		PACK_COLOR(240,	237,	161,	255)
+#define COLOR_COAL		PACK_COLOR(43,	41,		40,		255)
+#define COLOR_LEAVES	PACK_COLOR(37,	59,		35,		255)
+#define COLOR_WATER		PACK_COLOR(54,	122,	156,	255)
+#define COLOR_LAVA		PACK_COLOR(227,	157,	7,		255)
+#define COLOR_STEAM		PACK_COLOR(210,	211,	212,	255)
+#define COLOR_SMOKE		PACK_COLOR(62,	65,		66,		255)
+
+// Effect colours
+#define COLOR_FIRE		RANDOM_BOOL ? sf::Color(227, 102, 7, 255) : sf::Color(227, 157, 7, 255)
+#define COLOR_CLEAR		sf::Color(13,	14,		15,		255)
+#define COLOR_CHUNK		sf::Color(53,	58,		79,		255)
@@ -1,22 +1,22 @@
 #include "ParticleGas.h"
 #include "ParticleSimulation.h"
 
-void ParticleGas::HandleMovement()
+void ParticleGas::HandleMovement(ParticleSimulation& arSimulation)
 {
 	// First, attempt to move upwards
 	int itargetX = x;
 	int itargetY = y - 1;	// TO-DO: Replace 1 with a "velocity" value
 
-	if (!ParticleSimulation::QInstance().RequestParticleMove(iParticleID, itargetX, itargetY))
+	if (!arSimulation.RequestParticleMove(iParticleID, itargetX, itargetY))
 	{
 		// If that failed, attempt to move horizontally one way
 		itargetY = y;
 		itargetX += 1;
-		if (!ParticleSimulation::QInstance().RequestParticleMove(iParticleID, itargetX, itargetY))
+		if (!arSimulation.RequestParticleMove(iParticleID, itargetX, itargetY))
 		{
 			// If that fails, then try the other way
 			itargetX = x - 1;
-			if (!ParticleSimulation::QInstance().RequestParticleMove(iParticleID, itargetX, itargetY))
+			if (!arSimulation.RequestParticleMove(iParticleID, itargetX, itargetY))
 			{
 				// If all that fails, just stop
 				bResting = true;
@@ -29,12 +29,12 @@ void ParticleGas::HandleMovement()
 	y = itargetY;
 }
 
-void ParticleGas::HandleFireProperties()
+void ParticleGas::HandleFireProperties(ParticleSimulation&)
 {
-	--pProperties.iLifeTime;
+	--iLifeTime;
 }
 
 bool ParticleGas::QHasLifetimeExpired()
 {
-	return pProperties.iLifeTime <= 0 || bExpired;
+	return iLifeTime <= 0 || bExpired;
 }
\ No newline at end of file
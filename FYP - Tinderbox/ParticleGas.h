@@ -4,33 +4,36 @@
 struct GasProperties
 {
 	GasProperties() = default;
-	GasProperties(int aiLifeTime, sf::Color acColor)
+	constexpr GasProperties(int aiLifeTime, uint32_t auiColor)
+		: iLifeTime(aiLifeTime), uiColor(auiColor)
 	{
-		iLifeTime = aiLifeTime;
-		cColor = acColor;
 	}
 	int iLifeTime = 100;
-	sf::Color cColor;
+	uint32_t uiColor = 0;	// Packed RGBA
 };
 
-class ParticleGas : public Particle
+class ParticleGas final : public Particle
 {
 public:
-	ParticleGas(int aiID, unsigned int aiX, unsigned int aiY, uint8_t auiParticleType, GasProperties apProperties)
+	ParticleGas(int aiID, unsigned int aiX, unsigned int aiY, uint8_t auiParticleType, const GasProperties* apProperties)
 	{
 		iParticleID = aiID;
 		uiParticleType = auiParticleType;
+		eClass = PARTICLE_CLASS::GAS;
 		x = aiX;
 		y = aiY;
 		pProperties = apProperties;
-		cColor = pProperties.cColor;
+		iLifeTime = pProperties->iLifeTime;
 	}
 
-	void HandleMovement() override;
-	void HandleFireProperties() override;
+	void HandleMovement(ParticleSimulation& arSimulation) override;
+	void HandleFireProperties(ParticleSimulation& arSimulation) override;
 	bool QHasLifetimeExpired() override;
+	bool QNeedsUpdate() override { return true; }	// Gases burn through their lifetime, even while resting
+	sf::Color QColor() override { return sf::Color(pProperties->uiColor); }
 
 private:
-	GasProperties pProperties;
+	const GasProperties* pProperties;
+	int iLifeTime;
 };
 
@@ -4,29 +4,30 @@
 /// <summary>
 /// Handles the movement logic for the particle
 /// </summary>
-void ParticleLiquid::HandleMovement()
+/// <param name="arSimulation">Simulation the particle is being ticked in</param>
+void ParticleLiquid::HandleMovement(ParticleSimulation& arSimulation)
 {
 	// First, attempt to move downwards
 	int itargetX = x;
-	int itargetY = y + pProperties.iVelocityY;
+	int itargetY = y + pProperties->iVelocityY;
 
-	ParticleSimulation::QInstance().LineTest(QID(), x, y, itargetX, itargetY, itargetX , itargetY);
-	if (!ParticleSimulation::QInstance().RequestParticleMove(iParticleID, itargetX, itargetY))
+	arSimulation.LineTest(QID(), x, y, itargetX, itargetY, itargetX , itargetY);
+	if (!arSimulation.RequestParticleMove(iParticleID, itargetX, itargetY))
 	{
 		// If that failed, attempt to move horizontally one way
 		itargetY = y;
-		itargetX += pProperties.iVelocityX;
-		ParticleSimulation::QInstance().LineTest(QID(), x, y, itargetX, itargetY, itargetX, itargetY);
-		if (!ParticleSimulation::QInstance().RequestParticleMove(iParticleID, itargetX, itargetY))
+		itargetX += pProperties->iVelocityX;
+		arSimulation.LineTest(QID(), x, y, itargetX, itargetY, itargetX, itargetY);
+		if (!arSimulation.RequestParticleMove(iParticleID, itargetX, itargetY))
 		{
 			// If that fails, then try the other way
-			itargetX = x - pProperties.iVelocityX;
-			ParticleSimulation::QInstance().LineTest(QID(), x, y, itargetX, itargetY, itargetX, itargetY);
-			if (!ParticleSimulation::QInstance().RequestParticleMove(iParticleID, itargetX, itargetY))
+			itargetX = x - pProperties->iVelocityX;
+			arSimulation.LineTest(QID(), x, y, itargetX, itargetY, itargetX, itargetY);
+			if (!arSimulation.RequestParticleMove(iParticleID, itargetX, itargetY))
 			{
 				// If all that fails, just stop
-				++pProperties.iFailedMoveAttempts;
-				if (pProperties.iFailedMoveAttempts >= pProperties.iAttemptsBeforeRest)
+				++iFailedMoveAttempts;
+				if (iFailedMoveAttempts >= pProperties->iAttemptsBeforeRest)
 				{
 					bResting = true;
 				}
@@ -37,31 +38,32 @@ void ParticleLiquid::HandleMovement()
 	// Assuming we didn't return out after trying each option, assign our new internal position values to our targets
 	x = itargetX;
 	y = itargetY;
-	pProperties.iFailedMoveAttempts = 0;
+	iFailedMoveAttempts = 0;
 }
 #include <iostream>
 /// <summary>
 /// Handles fire propogation logic for this particle
 /// </summary>
-void ParticleLiquid::HandleFireProperties()
+/// <param name="arSimulation">Simulation the particle is being ticked in</param>
+void ParticleLiquid::HandleFireProperties(ParticleSimulation& arSimulation)
 {
 	// Extinguishes neighbors
-	if (pProperties.bShouldExinguish && ParticleSimulation::QInstance().ExtinguishNeighboringParticles(x, y))
+	if (pProperties->bShouldExinguish && arSimulation.ExtinguishNeighboringParticles(x, y))
 	{
-		pProperties.uiDeathParticleType = static_cast<uint8_t>(PARTICLE_TYPE::STEAM);
+		uiDeathParticleType = static_cast<uint8_t>(PARTICLE_TYPE::STEAM);
 		bExpired = true;
 	}
 
 	// Cooling/freezing behavior
-	if (pProperties.iCoolingRate > 0)
+	if (pProperties->iCoolingRate > 0)
 	{
-		if (iTicksSinceCool > pProperties.iCoolingRate)
+		if (iTicksSinceCool > pProperties->iCoolingRate)
 		{
 			iTicksSinceCool = 0;
 			temperature--;
-			if (temperature <= pProperties.iFreezingTemperature)
+			if (temperature <= pProperties->iFreezingTemperature)
 			{
-				pProperties.uiDeathParticleType = pProperties.uiFrozenParticleType;
+				uiDeathParticleType = pProperties->uiFrozenParticleType;
 				bExpired = true;
 			}
 		}
@@ -82,5 +84,5 @@ bool ParticleLiquid::QHasLifetimeExpired()
 /// </summary>
 uint8_t ParticleLiquid::QDeathParticleType()
 {
-	return pProperties.uiDeathParticleType;
+	return uiDeathParticleType;
 }
@@ -4,55 +4,50 @@
 struct LiquidProperties
 {
 	LiquidProperties() = default;
-	LiquidProperties(int aiAttemptsBeforeRest, uint8_t auiDeathParticleType, bool abShouldExinguish, bool abHeatSurroundings, int aiVelocityX, int aiVelocityY, sf::Color acColor, int aiFreezingTemperature, uint8_t auiFrozenParticleType, int aiCoolingRate)
+	constexpr LiquidProperties(int aiAttemptsBeforeRest, uint8_t auiDeathParticleType, bool abShouldExinguish, bool abHeatSurroundings, int aiVelocityX, int aiVelocityY, uint32_t auiColor, int aiFreezingTemperature, uint8_t auiFrozenParticleType, int aiCoolingRate)
+		: iAttemptsBeforeRest(aiAttemptsBeforeRest), uiDeathParticleType(auiDeathParticleType), bShouldExinguish(abShouldExinguish), bHeatSurroundings(abHeatSurroundings),
+		iVelocityX(aiVelocityX), iVelocityY(aiVelocityY), uiColor(auiColor), iFreezingTemperature(aiFreezingTemperature), uiFrozenParticleType(auiFrozenParticleType), iCoolingRate(aiCoolingRate)
 	{
-		iAttemptsBeforeRest = aiAttemptsBeforeRest;
-		iFailedMoveAttempts = 0;
-		uiDeathParticleType = auiDeathParticleType;
-		bShouldExinguish = abShouldExinguish;
-		bHeatSurroundings = abHeatSurroundings;
-		iVelocityX = aiVelocityX;
-		iVelocityY = aiVelocityY;
-		cColor = acColor;
-		iFreezingTemperature = aiFreezingTemperature;
-		uiFrozenParticleType = auiFrozenParticleType;
-		iCoolingRate = aiCoolingRate;
 	}
 	int iAttemptsBeforeRest = 30;
-	int iFailedMoveAttempts = 0;
 	uint8_t uiDeathParticleType = 0;
-	bool bShouldExinguish;
-	bool bHeatSurroundings;
+	bool bShouldExinguish = false;
+	bool bHeatSurroundings = false;
 	int iVelocityX = 2;
 	int iVelocityY = 4;
-	sf::Color cColor;
+	uint32_t uiColor = 0;	// Packed RGBA
 	int iFreezingTemperature = -5;
 	uint8_t uiFrozenParticleType = 0;
 	int iCoolingRate = 0;
 };
 
-class ParticleLiquid : public Particle
+class ParticleLiquid final : public Particle
 {
 public:
-	ParticleLiquid(int aiID, unsigned int aiX, unsigned int aiY, uint8_t auiParticleType, LiquidProperties apProperties)
+	ParticleLiquid(int aiID, unsigned int aiX, unsigned int aiY, uint8_t auiParticleType, const LiquidProperties* apProperties)
 	{
 		iParticleID = aiID;
 		uiParticleType = auiParticleType;
+		eClass = PARTICLE_CLASS::LIQUID;
 		x = aiX;
 		y = aiY;
 		pProperties = apProperties;
-		cColor = pProperties.cColor;
-		eFireState = apProperties.bHeatSurroundings ? PARTICLE_FIRE_STATE::BURNING : PARTICLE_FIRE_STATE::NONE;
-		temperature = apProperties.bHeatSurroundings ? FIRE_TEMP : 0;
+		uiDeathParticleType = pProperties->uiDeathParticleType;
+		eFireState = pProperties->bHeatSurroundings ? PARTICLE_FIRE_STATE::BURNING : PARTICLE_FIRE_STATE::NONE;
+		temperature = pProperties->bHeatSurroundings ? FIRE_TEMP : 0;
 	}
 
-	void HandleMovement() override;
-	void HandleFireProperties() override;
+	void HandleMovement(ParticleSimulation& arSimulation) override;
+	void HandleFireProperties(ParticleSimulation& arSimulation) override;
 	bool QHasLifetimeExpired() override;
 	uint8_t QDeathParticleType() override;
+	bool QNeedsUpdate() override { return !QResting() || pProperties->iCoolingRate > 0; }
+	sf::Color QColor() override { return sf::Color(pProperties->uiColor); }
 
 private:
-	LiquidProperties pProperties;
+	const LiquidProperties* pProperties;
+	int iFailedMoveAttempts = 0;
 	int iTicksSinceCool = 0;
+	uint8_t uiDeathParticleType;
 };
 
@@ -0,0 +1,220 @@
+#pragma once
+
+#include <cstdint>
+
+#include "ParticleColors.h"
+#include "ParticleGas.h"
+#include "ParticleLiquid.h"
+#include "ParticlePowder.h"
+#include "ParticleSimulation.h"
+#include "ParticleSolid.h"
+
+/// <summary>
+/// A single material's row in the material registry. Columns that don't apply to the material's class are left at 0, or -1 for temperatures.
+/// </summary>
+struct MaterialDefinition
+{
+	PARTICLE_TYPE eType;
+	PARTICLE_CLASS eClass;
+	uint8_t uiDensity;				// Relative weight of the material, from 0 (lightest) to 255 (heaviest). Decides which materials can displace each other.
+	uint32_t uiColor;				// Packed RGBA, drawn when no texture is loaded for the material
+	int iIgnitionTemperature;
+	int iBurningFuelConsumption;
+	int iFuel;						// Fuel burnt through once ignited. Gases burn through it as their lifetime.
+	int iVelocityX;
+	int iVelocityY;
+	int iAttemptsBeforeRest;
+	int iMeltingPoint;				// Solids only
+	int iFreezingTemperature;		// Liquids only
+	int iCoolingRate;				// Ticks between each step a liquid cools by. 0 for liquids that never cool.
+	PARTICLE_TYPE eDeathType;		// Spawned once a solid burns out or melts, or a liquid is spent extinguishing or freezes
+	PARTICLE_TYPE eFrozenType;		// Replaces eDeathType once a liquid freezes
+	bool bShouldExtinguish;			// Liquids only
+	bool bHeatSurroundings;			// Liquids only - the liquid spawns burning, and heats its neighbours
+};
+
+/// <summary>
+/// Every material in the simulation. Adding a material takes a PARTICLE_TYPE and a single row here - category checks, displacement rules and property tables are all generated from this table at compile time.
+/// </summary>
+constexpr MaterialDefinition materialDefinitions[] =
+{
+	//	Type					Class					Density	| Colour		| Ignition Temp | Fuel Consumption | Fuel	| Horizontal Velocity | Vertical Velocity | Attempts to Rest | Melting Point | Freezing Temp | Cooling Rate | Death Type				| Frozen Type			| Should Extinguish | Heat Surroundings
+	{ PARTICLE_TYPE::SAND,		PARTICLE_CLASS::POWDER,	150,	COLOR_SAND,		100,			1,					100,	1,					2,					100,				-1,				0,				0,				PARTICLE_TYPE::NONE,	PARTICLE_TYPE::NONE,	false,				false },
+	{ PARTICLE_TYPE::COAL,		PARTICLE_CLASS::POWDER,	130,	COLOR_COAL,		1000,			0,					1000,	1,					2,					100,				-1,				0,				0,				PARTICLE_TYPE::NONE,	PARTICLE_TYPE::NONE,	false,				false },
+	{ PARTICLE_TYPE::LEAVES,	PARTICLE_CLASS::POWDER,	110,	COLOR_LEAVES,	5,				1,					10,		1,					3,					100,				-1,				0,				0,				PARTICLE_TYPE::NONE,	PARTICLE_TYPE::NONE,	false,				false },
+	{ PARTICLE_TYPE::WOOD,		PARTICLE_CLASS::SOLID,	200,	COLOR_WOOD,		100,			1,					50,		0,					0,					0,					-1,				0,				0,				PARTICLE_TYPE::SMOKE,	PARTICLE_TYPE::NONE,	false,				false },
+	{ PARTICLE_TYPE::METAL,		PARTICLE_CLASS::SOLID,	250,	COLOR_METAL,	1000,			1,					700,	0,					0,					0,					-1,				0,				0,				PARTICLE_TYPE::SMOKE,	PARTICLE_TYPE::NONE,	false,				false },
+	{ PARTICLE_TYPE::ROCK,		PARTICLE_CLASS::SOLID,	220,	COLOR_ROCK,		3000,			1,					400,	0,					0,					0,					-1,				0,				0,				PARTICLE_TYPE::LAVA,	PARTICLE_TYPE::NONE,	false,				false },
+	{ PARTICLE_TYPE::STEAM,		PARTICLE_CLASS::GAS,	1,		COLOR_STEAM,	0,				0,					100,	0,					0,					0,					-1,				0,				0,				PARTICLE_TYPE::NONE,	PARTICLE_TYPE::NONE,	false,				false },
+	{ PARTICLE_TYPE::SMOKE,		PARTICLE_CLASS::GAS,	3,		COLOR_SMOKE,	0,				0,					100,	0,					0,					0,					-1,				0,				0,				PARTICLE_TYPE::NONE,	PARTICLE_TYPE::NONE,	false,				false },
+	{ PARTICLE_TYPE::WATER,		PARTICLE_CLASS::LIQUID,	100,	COLOR_WATER,	0,				0,					0,		2,					4,					100,				-1,				-25,			0,				PARTICLE_TYPE::STEAM,	PARTICLE_TYPE::NONE,	true,				false },
+	{ PARTICLE_TYPE::LAVA,		PARTICLE_CLASS::LIQUID,	140,	COLOR_LAVA,		0,				0,					0,		2,					2,					100,				-1,				-25,			100,			PARTICLE_TYPE::STEAM,	PARTICLE_TYPE::ROCK,	false,				true }
+};
+
+/// <summary>
+/// Lookups into materialDefinitions indexed directly by PARTICLE_TYPE, built at compile time.
+/// Types without a row, such as NONE and the class markers in PARTICLE_TYPE, have a class of PARTICLE_CLASS::COUNT.
+/// </summary>
+class MaterialRegistry
+{
+public:
+	constexpr MaterialRegistry()
+		: definitionIndices(), classes(), densities(), colors(), displacements()
+	{
+		for (int i = 0; i < static_cast<int>(PARTICLE_TYPE::COUNT); ++i)
+		{
+			definitionIndices[i] = -1;
+			classes[i] = PARTICLE_CLASS::COUNT;
+		}
+		for (int i = 0; i < static_cast<int>(sizeof(materialDefinitions) / sizeof(materialDefinitions[0])); ++i)
+		{
+			const int iType = static_cast<int>(materialDefinitions[i].eType);
+			bUnique = bUnique && definitionIndices[iType] == -1;
+			definitionIndices[iType] = i;
+			classes[iType] = materialDefinitions[i].eClass;
+			densities[iType] = materialDefinitions[i].uiDensity;
+			colors[iType] = materialDefinitions[i].uiColor;
+			iMaxVelocity = materialDefinitions[i].iVelocityX > iMaxVelocity ? materialDefinitions[i].iVelocityX : iMaxVelocity;
+			iMaxVelocity = materialDefinitions[i].iVelocityY > iMaxVelocity ? materialDefinitions[i].iVelocityY : iMaxVelocity;
+		}
+
+		// Falling materials sink through lighter liquids and gases, and gases rise through heavier gases. Solids never move, and are never displaced.
+		for (int iMoving = 0; iMoving < static_cast<int>(PARTICLE_TYPE::COUNT); ++iMoving)
+		{
+			for (int iTarget = 0; iTarget < static_cast<int>(PARTICLE_TYPE::COUNT); ++iTarget)
+			{
+				const bool bFalls = classes[iMoving] == PARTICLE_CLASS::POWDER || classes[iMoving] == PARTICLE_CLASS::LIQUID;
+				const bool bRises = classes[iMoving] == PARTICLE_CLASS::GAS;
+				const bool bTargetFluid = classes[iTarget] == PARTICLE_CLASS::LIQUID || classes[iTarget] == PARTICLE_CLASS::GAS;
+				displacements[iMoving][iTarget] = (bFalls && bTargetFluid && densities[iMoving] > densities[iTarget])
+					|| (bRises && classes[iTarget] == PARTICLE_CLASS::GAS && densities[iMoving] < densities[iTarget]);
+			}
+		}
+	}
+
+	constexpr bool QRegistered(PARTICLE_TYPE aeType) const					{ return definitionIndices[static_cast<int>(aeType)] != -1; }
+	constexpr const MaterialDefinition& QDefinition(PARTICLE_TYPE aeType) const	{ return materialDefinitions[definitionIndices[static_cast<int>(aeType)]]; }
+	constexpr PARTICLE_CLASS QClass(PARTICLE_TYPE aeType) const				{ return classes[static_cast<int>(aeType)]; }
+	constexpr uint8_t QDensity(PARTICLE_TYPE aeType) const					{ return densities[static_cast<int>(aeType)]; }
+	constexpr uint32_t QColor(PARTICLE_TYPE aeType) const					{ return colors[static_cast<int>(aeType)]; }
+	constexpr bool QUnique() const											{ return bUnique; }
+	constexpr int QMaxVelocity() const										{ return iMaxVelocity; }	// Largest horizontal or vertical velocity of any material, and at least 1 as every class that moves steps a cell
+
+	/// <summary>
+	/// Whether a moving material can swap places with another material in its way. A single lookup into the displacement matrix.
+	/// </summary>
+	constexpr bool QCanDisplace(PARTICLE_TYPE aeMovingType, PARTICLE_TYPE aeTargetType) const
+	{
+		return displacements[static_cast<int>(aeMovingType)][static_cast<int>(aeTargetType)] != 0;
+	}
+
+private:
+	int definitionIndices[static_cast<int>(PARTICLE_TYPE::COUNT)];
+	PARTICLE_CLASS classes[static_cast<int>(PARTICLE_TYPE::COUNT)];
+	uint8_t densities[static_cast<int>(PARTICLE_TYPE::COUNT)];
+	uint32_t colors[static_cast<int>(PARTICLE_TYPE::COUNT)];
+	uint8_t displacements[static_cast<int>(PARTICLE_TYPE::COUNT)][static_cast<int>(PARTICLE_TYPE::COUNT)];	// [Moving type][Target type], 1 where the moving type can swap with the target
+	bool bUnique = true;
+	int iMaxVelocity = 1;
+};
+
+constexpr MaterialRegistry materialRegistry;
+static_assert(materialRegistry.QUnique(), "Each material can only be registered once");
+static_assert(materialRegistry.QCanDisplace(PARTICLE_TYPE::SAND, PARTICLE_TYPE::WATER) && materialRegistry.QCanDisplace(PARTICLE_TYPE::LAVA, PARTICLE_TYPE::WATER)
+	&& materialRegistry.QCanDisplace(PARTICLE_TYPE::STEAM, PARTICLE_TYPE::SMOKE), "Sand and lava sink through water, and steam rises through smoke");
+
+// Furthest a particle reads or writes from its own cell in a tick, along either axis. It line tests and moves up to its velocity, then extinguishes the
+// neighbours of the cell it moved to, and wakes the cells around the one it left. Heating only reaches the direct neighbours of the cell it started in.
+constexpr int particleReach = (materialRegistry.QMaxVelocity() + 1) > QWakeNeighborReach() ? (materialRegistry.QMaxVelocity() + 1) : QWakeNeighborReach();
+static_assert(chunkSize >= 2 * particleReach, "Chunks of the same threaded phase are a chunk apart, so particles either side of it must never reach the same cell");
+
+#define IS_SOLID_CHECK(TYPE) \
+	(materialRegistry.QClass(TYPE) == PARTICLE_CLASS::SOLID)
+#define IS_POWDER_CHECK(TYPE) \
+	(materialRegistry.QClass(TYPE) == PARTICLE_CLASS::POWDER)
+#define IS_LIQUID_CHECK(TYPE) \
+	(materialRegistry.QClass(TYPE) == PARTICLE_CLASS::LIQUID)
+#define IS_GAS_CHECK(TYPE) \
+	(materialRegistry.QClass(TYPE) == PARTICLE_CLASS::GAS)
+
+/// <summary>
+/// Binds each particle class to the particle object and properties record that implement it, so per-class code can be generated from a material's class.
+/// </summary>
+template <PARTICLE_CLASS eClass>
+struct MaterialClassTraits;
+
+template <>
+struct MaterialClassTraits<PARTICLE_CLASS::POWDER>
+{
+	using ParticleType = ParticlePowder;
+	using Properties = PowderProperties;
+	static constexpr Properties MakeProperties(const MaterialDefinition& arMaterial)
+	{
+		return Properties(arMaterial.iAttemptsBeforeRest, arMaterial.iIgnitionTemperature, arMaterial.iBurningFuelConsumption, arMaterial.iFuel, arMaterial.iVelocityX, arMaterial.iVelocityY, arMaterial.uiColor);
+	}
+};
+
+template <>
+struct MaterialClassTraits<PARTICLE_CLASS::LIQUID>
+{
+	using ParticleType = ParticleLiquid;
+	using Properties = LiquidProperties;
+	static constexpr Properties MakeProperties(const MaterialDefinition& arMaterial)
+	{
+		return Properties(arMaterial.iAttemptsBeforeRest, static_cast<uint8_t>(arMaterial.eDeathType), arMaterial.bShouldExtinguish, arMaterial.bHeatSurroundings, arMaterial.iVelocityX, arMaterial.iVelocityY,
+			arMaterial.uiColor, arMaterial.iFreezingTemperature, static_cast<uint8_t>(arMaterial.eFrozenType), arMaterial.iCoolingRate);
+	}
+};
+
+template <>
+struct MaterialClassTraits<PARTICLE_CLASS::GAS>
+{
+	using ParticleType = ParticleGas;
+	using Properties = GasProperties;
+	static constexpr Properties MakeProperties(const MaterialDefinition& arMaterial)
+	{
+		return Properties(arMaterial.iFuel, arMaterial.uiColor);
+	}
+};
+
+template <>
+struct MaterialClassTraits<PARTICLE_CLASS::SOLID>
+{
+	using ParticleType = ParticleSolid;
+	using Properties = SolidProperties;
+	static constexpr Properties MakeProperties(const MaterialDefinition& arMaterial)
+	{
+		return Properties(arMaterial.iIgnitionTemperature, arMaterial.iBurningFuelConsumption, arMaterial.iFuel, arMaterial.uiColor, arMaterial.iMeltingPoint, static_cast<uint8_t>(arMaterial.eDeathType));
+	}
+};
+
+/// <summary>
+/// Flat, immutable table of the properties of every material in a class, indexed directly by PARTICLE_TYPE and built from materialDefinitions at compile time.
+/// Particles reference their material's record, rather than holding their own copy of it.
+/// </summary>
+template <PARTICLE_CLASS eClass>
+class ParticleMaterialTable
+{
+public:
+	using Properties = typename MaterialClassTraits<eClass>::Properties;
+
+	constexpr ParticleMaterialTable()
+		: records(), bHasRecord()
+	{
+		for (const MaterialDefinition& rMaterial : materialDefinitions)
+		{
+			if (rMaterial.eClass == eClass)
+			{
+				records[static_cast<int>(rMaterial.eType)] = MaterialClassTraits<eClass>::MakeProperties(rMaterial);
+				bHasRecord[static_cast<int>(rMaterial.eType)] = true;
+			}
+		}
+	}
+
+	constexpr const Properties& operator[](PARTICLE_TYPE aeType) const	{ return records[static_cast<int>(aeType)]; }
+	constexpr bool Contains(PARTICLE_TYPE aeType) const					{ return bHasRecord[static_cast<int>(aeType)]; }
+
+private:
+	Properties records[static_cast<int>(PARTICLE_TYPE::COUNT)];
+	bool bHasRecord[static_cast<int>(PARTICLE_TYPE::COUNT)];
+};
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "Particle.h"
+
+constexpr int particlePoolBlockSize = 1024;		// Number of particles allocated per arena block
+
+/// <summary>
+/// Allocation counters for a particle pool. Reset by the owning simulation at the start of each tick.
+/// </summary>
+struct ParticlePoolStats
+{
+	int iAllocations = 0;		// Particles constructed in the pool
+	int iRecycles = 0;			// Allocations served from the free list
+	int iFrees = 0;				// Particles returned to the pool
+	int iBlockAllocations = 0;	// Arena blocks requested from the heap
+};
+
+/// <summary>
+/// Type-erased interface to a particle pool, so particles can be returned without knowing their concrete type.
+/// </summary>
+class ParticlePoolBase
+{
+public:
+	virtual ~ParticlePoolBase() = default;
+	virtual void Release(Particle* apParticle) = 0;
+
+	const ParticlePoolStats& QStats() const	{ return stats; }
+	void ResetStats()						{ stats = ParticlePoolStats(); }
+
+protected:
+	ParticlePoolStats stats;
+};
+
+/// <summary>
+/// Deleter used by particle owners, handing the particle back to the pool it came from rather than to the heap.
+/// </summary>
+struct ParticlePoolDeleter
+{
+	ParticlePoolBase* pPool = nullptr;
+
+	void operator()(Particle* apParticle) const
+	{
+		if (pPool)
+		{
+			pPool->Release(apParticle);
+		}
+	}
+};
+
+using PooledParticlePtr = std::unique_ptr<Particle, ParticlePoolDeleter>;
+
+/// <summary>
+/// Arena allocator for a single particle class.
+/// Memory is requested from the heap in blocks of particlePoolBlockSize, and released particles are pushed onto an intrusive free list for reuse.
+/// Blocks are only returned to the heap when the pool is destroyed.
+/// </summary>
+template <typename T>
+class ParticlePool : public ParticlePoolBase
+{
+public:
+	/// <summary>
+	/// Constructs a new T in pooled memory
+	/// </summary>
+	template <typename... Args>
+	PooledParticlePtr Acquire(Args&&... aArgs)
+	{
+		Slot* pSlot = pFreeList;
+		if (pSlot)
+		{
+			pFreeList = pSlot->pNext;
+			++stats.iRecycles;
+		}
+		else
+		{
+			if (blocks.empty() || iNextSlotInBlock == particlePoolBlockSize)
+			{
+				blocks.push_back(std::make_unique<Slot[]>(particlePoolBlockSize));
+				iNextSlotInBlock = 0;
+				++stats.iBlockAllocations;
+			}
+			pSlot = &blocks.back()[iNextSlotInBlock++];
+		}
+		++stats.iAllocations;
+
+		T* pParticle = new (pSlot->storage) T(std::forward<Args>(aArgs)...);
+		return PooledParticlePtr(pParticle, ParticlePoolDeleter{ this });
+	}
+
+	/// <summary>
+	/// Destroys a particle, and pushes its memory onto the free list
+	/// </summary>
+	void Release(Particle* apParticle) override
+	{
+		Slot* pSlot = reinterpret_cast<Slot*>(static_cast<T*>(apParticle));
+		apParticle->~Particle();
+
+		pSlot->pNext = pFreeList;
+		pFreeList = pSlot;
+		++stats.iFrees;
+	}
+
+private:
+	union Slot
+	{
+		Slot* pNext;
+		alignas(T) unsigned char storage[sizeof(T)];
+	};
+
+	std::vector<std::unique_ptr<Slot[]>> blocks;
+	Slot* pFreeList = nullptr;
+	int iNextSlotInBlock = 0;
+};
@@ -6,28 +6,29 @@
 /// <summary>
 /// Handles the movement logic for this particle
 /// </summary>
-void ParticlePowder::HandleMovement()
+/// <param name="arSimulation">Simulation the particle is being ticked in</param>
+void ParticlePowder::HandleMovement(ParticleSimulation& arSimulation)
 {
 	// First, attempt to move downwards
 	int itargetX = x;
-	int itargetY = y + pProperties.iVelocityY;
+	int itargetY = y + pProperties->iVelocityY;
 
-	ParticleSimulation::QInstance().LineTest(QID(), x, y, itargetX, itargetY, itargetX, itargetY);
-	if (!ParticleSimulation::QInstance().RequestParticleMove(iParticleID, itargetX, itargetY))
+	arSimulation.LineTest(QID(), x, y, itargetX, itargetY, itargetX, itargetY);
+	if (!arSimulation.RequestParticleMove(iParticleID, itargetX, itargetY))
 	{
 		// If that failed, attempt to move diagonally one way
 		itargetY = y + 1;
 		itargetX += 1;
-		bool bCornerCheck = ParticleSimulation::QInstance().IsSpaceOccupied(itargetX, y);
-		if (bCornerCheck || !ParticleSimulation::QInstance().RequestParticleMove(iParticleID, itargetX, itargetY))
+		bool bCornerCheck = arSimulation.IsSpaceOccupied(itargetX, y);
+		if (bCornerCheck || !arSimulation.RequestParticleMove(iParticleID, itargetX, itargetY))
 		{
 			// If that fails, then try the other way
-			itargetX = x - 1; bCornerCheck = ParticleSimulation::QInstance().IsSpaceOccupied(itargetX, y);
-			if (bCornerCheck || !ParticleSimulation::QInstance().RequestParticleMove(iParticleID, itargetX, itargetY))
+			itargetX = x - 1; bCornerCheck = arSimulation.IsSpaceOccupied(itargetX, y);
+			if (bCornerCheck || !arSimulation.RequestParticleMove(iParticleID, itargetX, itargetY))
 			{
 				// If all that fails, just stop
-				++pProperties.iFailedMoveAttempts;
-				if (pProperties.iFailedMoveAttempts >= pProperties.iAttemptsBeforeRest)
+				++iFailedMoveAttempts;
+				if (iFailedMoveAttempts >= pProperties->iAttemptsBeforeRest)
 				{
 					bResting = true;
 				}
@@ -38,15 +39,15 @@ void ParticlePowder::HandleMovement()
 	// Assuming we didn't return out after trying each option, assign our new internal position values to our targets
 	x = itargetX;
 	y = itargetY;
-	pProperties.iFailedMoveAttempts = 0;
+	iFailedMoveAttempts = 0;
 }
 
 /// <summary>
 /// Handles the fire propogation logic for this particle+-
 /// </summary>
-void ParticlePowder::HandleFireProperties()
+void ParticlePowder::HandleFireProperties(ParticleSimulation&)
 {
-	if (temperature >= pProperties.iIgnitionTemperature)
+	if (temperature >= pProperties->iIgnitionTemperature)
 	{
 		Ignite();
 	}
@@ -54,8 +55,8 @@ void ParticlePowder::HandleFireProperties()
 	{
 		temperature = FIRE_TEMP;
 
-		pProperties.iFuel -= pProperties.iBurningFuelConsumption;
-		if (pProperties.iFuel <= 0)
+		iFuel -= pProperties->iBurningFuelConsumption;
+		if (iFuel <= 0)
 		{
 			bExpired = true;
 		}
@@ -81,7 +82,7 @@ void ParticlePowder::Ignite()
 void ParticlePowder::ForceWake()
 {
 	bResting = false;
-	pProperties.iFailedMoveAttempts = 0;
+	iFailedMoveAttempts = 0;
 }
 
 /// <summary>
@@ -97,7 +98,7 @@ bool ParticlePowder::QHasLifetimeExpired()
 /// </summary>
 int ParticlePowder::QIgnitionTemperature()
 {
-	return pProperties.iIgnitionTemperature;
+	return pProperties->iIgnitionTemperature;
 }
 
 /// <summary>
@@ -105,5 +106,5 @@ int ParticlePowder::QIgnitionTemperature()
 /// </summary>
 int ParticlePowder::QFuel()
 {
-	return pProperties.iFuel;
+	return iFuel;
 }
@@ -4,50 +4,47 @@
 struct PowderProperties
 {
 	PowderProperties() = default;
-	PowderProperties(int aiAttemptsBeforeRest, int aiIgnitionTemperature, int aiBurningFuelConsumption, int aiFuel, int aiVelocityX, int aiVelocityY, sf::Color acColor)
+	constexpr PowderProperties(int aiAttemptsBeforeRest, int aiIgnitionTemperature, int aiBurningFuelConsumption, int aiFuel, int aiVelocityX, int aiVelocityY, uint32_t auiColor)
+		: iAttemptsBeforeRest(aiAttemptsBeforeRest), iIgnitionTemperature(aiIgnitionTemperature), iBurningFuelConsumption(aiBurningFuelConsumption),
+		iFuel(aiFuel), iVelocityX(aiVelocityX), iVelocityY(aiVelocityY), uiColor(auiColor)
 	{
-		iAttemptsBeforeRest = aiAttemptsBeforeRest;
-		iFailedMoveAttempts = 0;
-		iIgnitionTemperature = aiIgnitionTemperature;
-		iBurningFuelConsumption = aiBurningFuelConsumption;
-		iFuel = aiFuel;
-		iVelocityX = aiVelocityX;
-		iVelocityY = aiVelocityY;
-		cColor = acColor;
 	}
 
 	int iAttemptsBeforeRest = 200;
-	int iFailedMoveAttempts = 0;
 	int iIgnitionTemperature = 100;
 	int iBurningFuelConsumption = 1;
 	int iFuel = 200;
 	int iVelocityX = 1;
 	int iVelocityY = 1;
-	sf::Color cColor;
+	uint32_t uiColor = 0;	// Packed RGBA
 };
 
-class ParticlePowder : public Particle
+class ParticlePowder final : public Particle
 {
 public:
-	ParticlePowder(int aiID, unsigned int aiX, unsigned int aiY, uint8_t auiParticleType, PowderProperties apProperties)
+	ParticlePowder(int aiID, unsigned int aiX, unsigned int aiY, uint8_t auiParticleType, const PowderProperties* apProperties)
 	{
 		iParticleID = aiID;
 		uiParticleType = auiParticleType;
+		eClass = PARTICLE_CLASS::POWDER;
 		x = aiX;
 		y = aiY;
 		pProperties = apProperties;
-		cColor = pProperties.cColor;
+		iFuel = pProperties->iFuel;
 	}
 
-	void HandleMovement() override;
-	void HandleFireProperties() override;
+	void HandleMovement(ParticleSimulation& arSimulation) override;
+	void HandleFireProperties(ParticleSimulation& arSimulation) override;
 	void Ignite() override;
 	void ForceWake() override;
 	bool QHasLifetimeExpired() override;
 	int QIgnitionTemperature() override;
 	int QFuel() override;
+	sf::Color QColor() override { return sf::Color(pProperties->uiColor); }
 
 private:
-	PowderProperties pProperties;
+	const PowderProperties* pProperties;
+	int iFuel;
+	int iFailedMoveAttempts = 0;
 };
 
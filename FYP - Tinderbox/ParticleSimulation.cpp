@@ -1,17 +1,28 @@
 #include "ParticleSimulation.h"
 
+#include "ChunkStore.h"
+#include "ParticleColors.h"
 #include "ParticleGas.h"
 #include "ParticleLiquid.h"
+#include "ParticleMaterials.h"
 #include "ParticlePowder.h"
 #include "ParticleSolid.h"
+#include "WorkerThreadPool.h"
 
 #include <SFML/Graphics.hpp>
 
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdlib>
 #include <ctime>
 #include <cmath>
 #include <iostream>
-#include <mutex>
-#include <thread>
 #include <vector>
 
 // TO-DO: Move this to a pre-processor define
@@ -19,103 +30,196 @@
 #define USE_THREADED_CHUNKS
 #endif
 
-constexpr float fFixedTickRate = 60.0f;											// Number of ticks per second
-constexpr float fFixedTickInterval = (1.0f / fFixedTickRate) * CLOCKS_PER_SEC;	// Time between ticks
-
-#define CREATE_PARTICLE_PTR(T, PT, PP) \
-	std::make_shared<T>(iUniqueParticleID, aiX, aiY, static_cast<uint8_t>(PT), PP)
-
-#define RANDOM_INT(MIN, MAX) \
-	rand() % (MAX - MIN + 1) + MIN
-
-#define RANDOM_BOOL \
-	RANDOM_INT(0, 100) > 50
-
-// Primitive Colours
-#define COLOR_GREY	sf::Color(150,	150,	150,	255)
-#define COLOR_PINK	sf::Color(197,	61,		227,	255)
-
-// Element colours
-#define COLOR_WOOD		sf::Color(82,	56,		33,		255)
-#define COLOR_METAL		sf::Color(81,	86,		89,		255)
-#define COLOR_ROCK		sf::Color(128,	134,	128,	255)
-#define COLOR_SAND		sf::Color(240,	237,	161,	255)
-#define COLOR_COAL		sf::Color(43,	41,		40,		255)
-#define COLOR_LEAVES	sf::Color(37,	59,		35,		255)
-#define COLOR_WATER		sf::Color(54,	122,	156,	255)
-#define COLOR_LAVA		sf::Color(227,	157,	7,		255)
-#define COLOR_STEAM		sf::Color(210,	211,	212,	255)
-#define COLOR_SMOKE		sf::Color(62,	65,		66,		255)
-#define COLOR_FIRE		RANDOM_BOOL ? sf::Color(227, 102, 7, 255) : sf::Color(227, 157, 7, 255)
-#define COLOR_CHUNK		sf::Color(53,	58,		79,		255)
-
-#define IS_SOLID_CHECK(TYPE) \
-	(TYPE > PARTICLE_TYPE::SOLID && TYPE < PARTICLE_TYPE::GAS)
-#define IS_POWDER_CHECK(TYPE) \
-	(TYPE > PARTICLE_TYPE::POWDER && TYPE < PARTICLE_TYPE::SOLID)
-#define IS_LIQUID_CHECK(TYPE) \
-	(TYPE > PARTICLE_TYPE::LIQUID && TYPE < PARTICLE_TYPE::COUNT)
-#define IS_GAS_CHECK(TYPE) \
-	(TYPE > PARTICLE_TYPE::GAS && TYPE < PARTICLE_TYPE::LIQUID)
-
-std::unordered_map<PARTICLE_TYPE, SolidProperties>	solidPropertiesMap 
-{
-	//										Ignition Temp | Fuel Consumption | Fuel	  | Colour			| Melting Point		| Melted particle Type	
-	{PARTICLE_TYPE::ROCK,	SolidProperties(3000,				1,				400,	COLOR_ROCK,			-1,				static_cast<uint8_t>(PARTICLE_TYPE::LAVA))},
-	{PARTICLE_TYPE::METAL,	SolidProperties(1000,				1,				700,	COLOR_METAL,		-1,				static_cast<uint8_t>(PARTICLE_TYPE::SMOKE)) },
-	{PARTICLE_TYPE::WOOD,	SolidProperties(100,				1,				50,		COLOR_WOOD,			-1,				static_cast<uint8_t>(PARTICLE_TYPE::SMOKE)) }
+#define EMPLACE_PARTICLE(T, POOL, PT, PP) \
+	particleMap.Emplace<T>(POOL, aiX, aiY, static_cast<uint8_t>(PT), PP)
+
+// Built from materialDefinitions at compile time
+constexpr ParticleMaterialTable<PARTICLE_CLASS::SOLID>		solidPropertiesTable;
+constexpr ParticleMaterialTable<PARTICLE_CLASS::POWDER>	powderPropertiesTable;
+constexpr ParticleMaterialTable<PARTICLE_CLASS::LIQUID>	liquidPropertiesTable;
+constexpr ParticleMaterialTable<PARTICLE_CLASS::GAS>		gasPropertiesTable;
+
+// Sparse worlds free a chunk's storage once it has been asleep and empty for this many ticks
+constexpr uint32_t sparseChunkReleaseTicks = 120;
+// Number of chunks checked for release each tick. Checks cycle through every chunk in turn, so the cost per tick doesn't grow with the world.
+constexpr int sparseChunkReleaseScanCount = 256;
+
+/// <summary>
+/// Inclusive rectangle of cells within a chunk. Empty while iMinX > iMaxX.
+/// </summary>
+struct ChunkRect
+{
+	int iMinX, iMinY, iMaxX, iMaxY;
 };
-std::unordered_map<PARTICLE_TYPE, PowderProperties> powderPropertiesMap
+
+/// <summary>
+/// Rectangle of cells within a chunk that changed this tick, and so need processing next tick.
+/// Bounds are atomic, as particles near a chunk's edge can mark cells in a neighboring chunk that is being ticked on another thread.
+/// </summary>
+struct ChunkDirtyRect
 {
-	//											Ticks to Rest | Ignition Temp | Fuel Consumption | Fuel | Horizontal Velocity | Vertical Veloctiy	| Colour
-	{PARTICLE_TYPE::SAND,		PowderProperties(100,			100,			1,					100,		1,					2,					COLOR_SAND)},
-	{PARTICLE_TYPE::COAL,		PowderProperties(100,			1000,			0,					1000,		1,					2,					COLOR_COAL)},
-	{PARTICLE_TYPE::LEAVES,		PowderProperties(100,			5,				1,					10,			1,					3,					COLOR_LEAVES)}
+	std::atomic<int> iMinX, iMinY, iMaxX, iMaxY;
+	std::atomic<bool> bQueued;		// Set once the chunk has been added to queuedChunkIDs
+
+	void Reset()
+	{
+		iMinX = INT_MAX;
+		iMinY = INT_MAX;
+		iMaxX = -1;
+		iMaxY = -1;
+		bQueued = false;
+	}
 };
-std::unordered_map<PARTICLE_TYPE, LiquidProperties> liquidPropertiesMap
+
+/// <summary>
+/// Results of ticking a single chunk, gathered by Tick once every chunk has finished
+/// </summary>
+struct ChunkTickResults
 {
-	//										Ticks to Rest	| Extinguish Particle Type							| Should Extinguish	| Heat Surroundings		| Horizontal Velocity | Vertical Veloctiy | Colour			| Freezing Temp		| Frozen Type										| Cooling rate
-	{PARTICLE_TYPE::WATER,	LiquidProperties(100,				static_cast<uint8_t>(PARTICLE_TYPE::STEAM),				true,			false,					2,						4,				COLOR_WATER,		-25,				0,													0)},
-	{PARTICLE_TYPE::LAVA,	LiquidProperties(100,				static_cast<uint8_t>(PARTICLE_TYPE::STEAM),				false,			true,					2,						2,				COLOR_LAVA,			-25,				static_cast<uint8_t>(PARTICLE_TYPE::ROCK),			100)}
+	std::vector<int> expiredIDs;
+	int iBurningParticles = 0;
+	int iCellVisits = 0;
+	int iRedrawVisits = 0;
+	int iWakeVisits = 0;
+	std::vector<Particle*> classBatches[static_cast<int>(PARTICLE_CLASS::COUNT)];		// Particles gathered for each class while batching by class
+	long long classTickNanoseconds[static_cast<int>(PARTICLE_CLASS::COUNT)] = {};
 };
-std::unordered_map<PARTICLE_TYPE, GasProperties>	gasPropertiesMap
+
+/// <summary>
+/// Whether a chunk of a streaming simulation is in memory
+/// </summary>
+enum class CHUNK_RESIDENCY : uint8_t
 {
-	//									Lifetime | Colour
-	{PARTICLE_TYPE::STEAM,	GasProperties(100,		COLOR_STEAM)},
-	{PARTICLE_TYPE::SMOKE,	GasProperties(100,		COLOR_SMOKE)}
+	RESIDENT,		// In memory, and simulated
+	UNLOADED,		// Not in memory, with nothing stored. Becomes resident as soon as it is needed.
+	PAGED_OUT,		// Not in memory, with its particles held in the chunk store
+	PAGING_IN		// Waiting on the chunk store to read its particles back
 };
 
-std::unordered_map<PARTICLE_TYPE, sf::Image*> particleTextureAtlas;
+// Most chunks paged in, and most paged out, each tick. Spreads the cost of a large focus move over several ticks.
+constexpr int streamingChunksPerTick = 8;
 
-bool bSleepingChunks[chunkCount];
-bool bChunksNeedUpdating[chunkCount] = { false };
-std::unordered_map<int, std::shared_ptr<Particle>> chunkParticleMaps[chunkCount];
+/// <summary>
+/// Sets a chunk's residency, keeping iResidentChunks up to date. Chunks leaving residency are sealed with walls, and unsealed again when they return.
+/// </summary>
+/// <remarks>A chunk must be empty when it leaves residency.</remarks>
+void ParticleSimulation::SetChunkResidency(int aiChunkID, CHUNK_RESIDENCY aeResidency)
+{
+	const bool bResident = aeResidency == CHUNK_RESIDENCY::RESIDENT;
+	if ((chunkResidency[aiChunkID] == CHUNK_RESIDENCY::RESIDENT) != bResident)
+	{
+		iResidentChunks += bResident ? 1 : -1;
+		particleIDMap.SetSquareSealed((aiChunkID % iChunkCountX) * chunkSize, (aiChunkID / iChunkCountX) * chunkSize, chunkSize, !bResident);
+		if (!bResident)
+		{
+			particleHeatMap.ReleaseBlockIfEmpty(aiChunkID);
+		}
+	}
+	chunkResidency[aiChunkID] = aeResidency;
+}
 
-#ifdef USE_THREADED_CHUNKS
-std::mutex ParticleMapLock;
-std::mutex ExpiredIDLock;
-std::mutex ChunkTickLock;
+/// <summary>
+/// Starts bringing a chunk back into memory. Chunks with nothing stored become resident straight away.
+/// </summary>
+void ParticleSimulation::RequestChunkPageIn(int aiChunkID)
+{
+	if (chunkResidency[aiChunkID] == CHUNK_RESIDENCY::UNLOADED)
+	{
+		SetChunkResidency(aiChunkID, CHUNK_RESIDENCY::RESIDENT);
+	}
+	else if (chunkResidency[aiChunkID] == CHUNK_RESIDENCY::PAGED_OUT)
+	{
+		SetChunkResidency(aiChunkID, CHUNK_RESIDENCY::PAGING_IN);
+		chunkStore->Load(aiChunkID);
+	}
+}
+
+/// <summary>
+/// Sets or clears the given bits of a column mask. Only writes if they change, as most cells keep their state.
+/// </summary>
+inline void SetColumnBits(std::atomic<uint32_t>& arMask, uint32_t auiBits, bool abSet)
+{
+	if (((arMask.load(std::memory_order_relaxed) & auiBits) != 0) != abSet)
+	{
+		abSet ? arMask.fetch_or(auiBits, std::memory_order_relaxed) : arMask.fetch_and(~auiBits, std::memory_order_relaxed);
+	}
+}
+
+/// <summary>
+/// Flips a bit for each of two cells in a set of masks, in a single write when both share a mask
+/// </summary>
+inline void FlipMaskBits(std::atomic<uint32_t>* apMasks, size_t auiIndex, uint32_t auiBit, size_t auiNewIndex, uint32_t auiNewBit)
+{
+	if (auiIndex == auiNewIndex)
+	{
+		apMasks[auiIndex].fetch_xor(auiBit | auiNewBit, std::memory_order_relaxed);
+	}
+	else
+	{
+		apMasks[auiIndex].fetch_xor(auiBit, std::memory_order_relaxed);
+		apMasks[auiNewIndex].fetch_xor(auiNewBit, std::memory_order_relaxed);
+	}
+}
+
+/// <summary>
+/// Returns the index of the lowest set bit. auiBits must not be 0.
+/// </summary>
+inline int LowestSetBit(uint32_t auiBits)
+{
+#ifdef _MSC_VER
+	unsigned long ulIndex;
+	_BitScanForward(&ulIndex, auiBits);
+	return static_cast<int>(ulIndex);
+#else
+	return __builtin_ctz(auiBits);
 #endif
+}
+
+/// <summary>
+/// Returns the index of the highest set bit. auiBits must not be 0.
+/// </summary>
+inline int HighestSetBit(uint32_t auiBits)
+{
+#ifdef _MSC_VER
+	unsigned long ulIndex;
+	_BitScanReverse(&ulIndex, auiBits);
+	return static_cast<int>(ulIndex);
+#else
+	return 31 - __builtin_clz(auiBits);
+#endif
+}
+
+inline void AtomicMin(std::atomic<int>& arValue, int aiCandidate)
+{
+	int iCurrent = arValue.load(std::memory_order_relaxed);
+	while (aiCandidate < iCurrent && !arValue.compare_exchange_weak(iCurrent, aiCandidate, std::memory_order_relaxed)) {}
+}
+
+inline void AtomicMax(std::atomic<int>& arValue, int aiCandidate)
+{
+	int iCurrent = arValue.load(std::memory_order_relaxed);
+	while (aiCandidate > iCurrent && !arValue.compare_exchange_weak(iCurrent, aiCandidate, std::memory_order_relaxed)) {}
+}
 
 template <typename F>
-void ForEachParticle(std::unordered_map<int, std::shared_ptr<Particle>> aParticleMap, F afFunctor)
+void ForEachParticle(ParticleSlotMap& aParticleMap, F afFunctor)
 {
-	for (std::pair<const int, std::shared_ptr<Particle>> mapping : aParticleMap)
+	for (PooledParticlePtr& pParticle : aParticleMap)
 	{
-		afFunctor(mapping);
+		afFunctor(pParticle.get());
 	}
 }
 
 /// <summary>
 /// Handles the updating and drawing of particles.
 /// </summary>
-/// <param name="arCanvas">Reference to the sf::Image to draw the simulation onto.</param>
+/// <param name="arCanvas">Reference to the sf::Image to draw the simulation onto. Only cells that changed are redrawn, so the canvas must persist between ticks.</param>
+/// <remarks>Each chunk only processes the cells inside the rectangle marked dirty during the previous tick, so the cost of a tick scales with the active region rather than the whole simulation.</remarks>
 bool ParticleSimulation::Tick(sf::Image& arCanvas)
 {
 	std::vector<int> expiredParticleIDs;
 	iPixelsVisitted_Total = 0;
-	iPixelsVisitted_PreChunk = 0;
-	iPixelsVisitted_AllowUpdate = 0;
+	iPixelsVisitted_Redraw = 0;
 	iPixelsVisitted_ExpiredCleanup = 0;
 	iPixelsVisitted_ChunkTick = 0;
 	iPixelsVisitted_WakeChunk = 0;
@@ -125,298 +229,908 @@ bool ParticleSimulation::Tick(sf::Image& arCanvas)
 	bool bRunFullTick = false;
 
 	clock_t cDeltaClock = clock() - cClock;
-	bRunFullTick = cDeltaClock > fFixedTickInterval;
+	bRunFullTick = !bPaceTicks || cDeltaClock > fFixedTickInterval;
+
+	if (!bRunFullTick && !bForceFullUpdate)
+	{
+		return false;
+	}
+	cClock = clock();
+	bForceFullUpdate = false;
+	++uiTickEpoch;
+
+	// Only reset on full ticks, so the pool counters cover everything since the last one, including spawns made between ticks
+	powderPool.ResetStats();
+	liquidPool.ResetStats();
+	gasPool.ResetStats();
+	solidPool.ResetStats();
+
+	UpdateStreaming();
+
+	// Swap in the cells marked dirty since the last tick. Chunks that weren't marked sleep through this tick, and are never visited.
+	// Chunks are sorted so they tick in the same order regardless of the order they were marked in.
+	awakeChunkIDs.assign(queuedChunkIDs.get(), queuedChunkIDs.get() + iQueuedChunkCount);
+	iQueuedChunkCount = 0;
+	std::sort(awakeChunkIDs.begin(), awakeChunkIDs.end());
+	for (int iChunkID : awakeChunkIDs)
+	{
+		ChunkDirtyRect& rDirtyRect = chunkDirtyRects[iChunkID];
+		chunkUpdateRects[iChunkID] = { rDirtyRect.iMinX, rDirtyRect.iMinY, rDirtyRect.iMaxX, rDirtyRect.iMaxY };
+		rDirtyRect.Reset();
+
+		bSleepingChunks[iChunkID] = false;
+		chunkLastAwakeTick[iChunkID] = uiTickEpoch;
+	}
+
+#ifdef USE_THREADED_CHUNKS
+	// No two chunks in a phase are adjacent, so they never touch the same cells, and can run in parallel without locking.
+	for (std::vector<int>& rPhaseChunkIDs : phaseChunkIDs)
+	{
+		rPhaseChunkIDs.clear();
+	}
+	for (int iChunkID : awakeChunkIDs)
+	{
+		const int iPhaseX = (iChunkID % iChunkCountX) % 2;
+		const int iPhaseY = (iChunkID / iChunkCountX) % 2;
+		phaseChunkIDs[(iPhaseY * 2) + iPhaseX].push_back(iChunkID);
+	}
+	for (const std::vector<int>& rPhaseChunkIDs : phaseChunkIDs)
+	{
+		chunkWorkerPool->Run(static_cast<int>(rPhaseChunkIDs.size()), [this, &arCanvas, &rPhaseChunkIDs](int aiJob) { TickChunk(rPhaseChunkIDs[aiJob], &arCanvas); });
+	}
+#else
+	for (int iChunkID : awakeChunkIDs)
+	{
+		TickChunk(iChunkID, &arCanvas);
+	}
+#endif
+
+	// Sleeping chunks marked dirty this tick need redrawing too, such as those a particle has just moved into
+	drawnChunkIDs = awakeChunkIDs;
+	for (int i = 0; i < iQueuedChunkCount; ++i)
+	{
+		if (bSleepingChunks[queuedChunkIDs[i]])
+		{
+			drawnChunkIDs.push_back(queuedChunkIDs[i]);
+		}
+	}
+
+#ifdef USE_THREADED_CHUNKS
+	// Drawing only reads the simulation, so every chunk can be redrawn at once
+	chunkWorkerPool->Run(static_cast<int>(drawnChunkIDs.size()), [this, &arCanvas](int aiJob) { DrawChunk(drawnChunkIDs[aiJob], arCanvas); });
+#else
+	for (int iChunkID : drawnChunkIDs)
+	{
+		DrawChunk(iChunkID, arCanvas);
+	}
+#endif
 
-	// Pre chunk tick - cache all particles we want a given chunk index to handle
-	for (std::pair<const int, std::shared_ptr<Particle>> mapping : particleMap)
+	// Gather the results of each chunk
+	for (int iChunkID : drawnChunkIDs)
 	{
-		if (mapping.second)
+		ChunkTickResults& rResults = chunkTickResults[iChunkID];
+		expiredParticleIDs.insert(expiredParticleIDs.end(), rResults.expiredIDs.begin(), rResults.expiredIDs.end());
+		iBurningParticles += rResults.iBurningParticles;
+		iPixelsVisitted_Total += rResults.iCellVisits + rResults.iRedrawVisits + rResults.iWakeVisits;	// Chunk tick, redraw and wake pixel visits
+		iPixelsVisitted_ChunkTick += rResults.iCellVisits;
+		iPixelsVisitted_Redraw += rResults.iRedrawVisits;
+		iPixelsVisitted_WakeChunk += rResults.iWakeVisits;
+
+		rResults.expiredIDs.clear();
+		rResults.iBurningParticles = 0;
+		rResults.iCellVisits = 0;
+		rResults.iRedrawVisits = 0;
+		rResults.iWakeVisits = 0;
+	}
+	for (int iClass = 0; iClass < static_cast<int>(PARTICLE_CLASS::COUNT); ++iClass)
+	{
+		long long iNanoseconds = 0;
+		for (int iChunkID : awakeChunkIDs)
 		{
-			const int x = mapping.second->QX();
-			const int y = mapping.second->QY();
-			bool bHasMoved = false;
+			iNanoseconds += chunkTickResults[iChunkID].classTickNanoseconds[iClass];
+			chunkTickResults[iChunkID].classTickNanoseconds[iClass] = 0;
+		}
+		classTickMicroseconds[iClass] = static_cast<int>(iNanoseconds / 1000);
+	}
+	iChunksVisitted = static_cast<int>(awakeChunkIDs.size());
+
+	// Put the awake chunks back to sleep, ready for the next tick
+	for (int iChunkID : awakeChunkIDs)
+	{
+		bSleepingChunks[iChunkID] = true;
+		chunkUpdateRects[iChunkID] = { INT_MAX, INT_MAX, -1, -1 };
+	}
+
+	// During the course of a tick, we check if a particle has expired it's lifetime. These particles are collected in expiredParticleIDs.
+	// Erasing a handle from the slot map frees the particle, and invalidates any stale copies of that handle.
+	for (int aiExpiredID : expiredParticleIDs)
+	{
+		Particle* pExpired = GetParticleFromMap(aiExpiredID);
+		if (pExpired)
+		{
+			const int x = pExpired->QX();
+			const int y = pExpired->QY();
+
+			const PARTICLE_TYPE uiDeathParticleType = static_cast<PARTICLE_TYPE>(pExpired->QDeathParticleType());
+			bool bCanSpawnDeathParticle = IS_SOLID_CHECK(static_cast<PARTICLE_TYPE>(pExpired->QType())) || IS_LIQUID_CHECK(static_cast<PARTICLE_TYPE>(pExpired->QType()));
+
+			particleIDMap(x, y) = NULL_PARTICLE_ID;
+			UpdateCellOccupancy(x, y);
+			MarkCellDirty(x, y);
 
-			if (bRunFullTick || bForceFullUpdate)
+			if (pExpired->QCountedActive())
 			{
-				cClock = clock();
-				bForceFullUpdate = false;
+				--iActiveParticles;
+			}
+
+			// Remove the particle from the slot map
+			particleMap.Erase(aiExpiredID);
 
-				// First, find the chunk this particle belongs to
-				const int iParticleChunkID = GetChunkForPosition(mapping.second->QX());
-				if (bChunksNeedUpdating[iParticleChunkID])
+			if (bCanSpawnDeathParticle)
+			{
+				if (uiDeathParticleType != PARTICLE_TYPE::NONE)
 				{
-					mapping.second->ForceWake();
+					SpawnParticle(x, y, uiDeathParticleType);
 				}
+			}
+
+			// Wake any resting particles that could move into the space this particle left
+			const int iWakeVisits = WakeNeighboringParticles(x, y);
+			iPixelsVisitted_Total += iWakeVisits;
+			iPixelsVisitted_WakeChunk += iWakeVisits;
+
+			++iPixelsVisitted_Total;	// Clean up expired pixel visits
+			++iPixelsVisitted_ExpiredCleanup;
+		}
+	}
+	expiredParticleIDs.clear();
+
+	if (particleIDMap.QSparse())
+	{
+		ReleaseEmptyChunks();
+	}
+
+	return bRunFullTick;
+}
+
+/// <summary>
+/// Creates a simulation of the given size. Every instance keeps its own chunk state, so instances can run side by side.
+/// </summary>
+/// <param name="aiWidth">Width of the simulation, in cells</param>
+/// <param name="aiHeight">Height of the simulation, in cells</param>
+/// <param name="abSparse">When true, only chunks holding particles are stored</param>
+ParticleSimulation::ParticleSimulation(int aiWidth, int aiHeight, bool abSparse)
+{
+	Initialize();
+	ResizeSimulation(aiWidth, aiHeight, abSparse);
+	cClock = clock();
+}
+
+/// <summary>
+/// Frees the particle texture atlas. Chunk tables, the chunk store and worker pool are freed with the simulation.
+/// </summary>
+ParticleSimulation::~ParticleSimulation()
+{
+	for (auto& rTexture : particleTextureAtlas)
+	{
+		delete rTexture.second;
+	}
+}
+
+/// <summary>
+/// Initializes any cached data for the simulation, such as the particle texture atlas
+/// </summary>
+void ParticleSimulation::Initialize()
+{
+	auto TextureLoaderFunctor = [&](PARTICLE_TYPE aeParticleType, std::string asFilepath)
+		{
+			sf::Image* img = new sf::Image();
+			if (img->loadFromFile(asFilepath))
+			{
+				particleTextureAtlas.emplace(aeParticleType, img);
+			}
+		};
+
+	// Load all particle textures into the atlas here
+	TextureLoaderFunctor(PARTICLE_TYPE::COAL, "Assets\\Sprites\\T_Coal.png");
+	TextureLoaderFunctor(PARTICLE_TYPE::SAND, "Assets\\Sprites\\T_Sand.png");
+	TextureLoaderFunctor(PARTICLE_TYPE::LEAVES, "Assets\\Sprites\\T_Leaves.png");
+	TextureLoaderFunctor(PARTICLE_TYPE::WOOD, "Assets\\Sprites\\T_Wood.png");
+	TextureLoaderFunctor(PARTICLE_TYPE::ROCK, "Assets\\Sprites\\T_Stone.png");
 
 #ifdef USE_THREADED_CHUNKS
-				if (!mapping.second->QResting() && !mapping.second->QHasLifetimeExpired())
-				{
-					chunkParticleMaps[iParticleChunkID].emplace(mapping.second->QID(), mapping.second);
-				}
+	chunkWorkerPool = std::make_unique<WorkerThreadPool>(WorkerThreadPool::QHardwareWorkerCount());
 #endif
+}
 
-				if (!mapping.second->QResting())
-				{
-					if (!mapping.second->QHasBeenUpdatedThisTick())
-					{
-						mapping.second->HandleMovement();
-						mapping.second->SetHasBeenUpdated(true);
+/// <summary>
+/// Handles the movement, fire and drawing of a single particle
+/// </summary>
+/// <param name="apParticle">Particle to update</param>
+/// <param name="arCanvas">Canvas to draw to</param>
+/// <param name="arResults">Results of the chunk this particle is being ticked in</param>
+/// <remarks>Every particle class is final, so when T is a particle class its behaviours are called directly rather than through the vtable.</remarks>
+template <typename T>
+void ParticleSimulation::TickParticle(T* apParticle, sf::Image& arCanvas, ChunkTickResults& arResults)
+{
+	const int x = apParticle->QX();
+	const int y = apParticle->QY();
+	bool bHasMoved = false;
+
+	apParticle->SetLastUpdatedTick(uiTickEpoch);
+
+	if (!apParticle->QResting())
+	{
+		apParticle->HandleMovement(*this);
+		bHasMoved = apParticle->QX() != x || apParticle->QY() != y;
+	}
+
+	apParticle->HandleFireProperties(*this);
 
-						bHasMoved = mapping.second->QX() != x || mapping.second->QY() != y;
-					}
+	// If the particle is on fire, we need to heat the surroundings
+	if (apParticle->QIsOnFire())
+	{
+		++arResults.iBurningParticles;
+		auto HeatSurroundingsFunctor = [this](int aiX, int aiY, int aiTempStep)
+			{
+				// Walls never refer to a particle, so the simulation's edge needs no check
+				Particle* pNeighbor = GetParticleFromMap(particleIDMap(aiX, aiY));
+				if (pNeighbor)
+				{
+					pNeighbor->IncreaseTemperature(aiTempStep);
+					MarkCellDirty(aiX, aiY);
 				}
+			};
+
+		const int iIgnitionStep = apParticle->QTemperature() * 0.05f;	// TO-DO: Replace this with a value in the particle itself
+		HeatSurroundingsFunctor(x + 1, y, iIgnitionStep);
+		HeatSurroundingsFunctor(x - 1, y, iIgnitionStep);
+		HeatSurroundingsFunctor(x, y + 1, iIgnitionStep);
+		HeatSurroundingsFunctor(x, y - 1, iIgnitionStep);
+	}
+
+	// Keep the particle's cell dirty while it still has work to do, and redraw the cell it left behind
+	const int iNewX = apParticle->QX();
+	const int iNewY = apParticle->QY();
+	if (apParticle->QNeedsUpdate() || apParticle->QIsOnFire() || apParticle->QHasLifetimeExpired())
+	{
+		MarkCellDirty(iNewX, iNewY);
+	}
+	if (bHasMoved)
+	{
+		MarkCellDirty(x, y);
+		arResults.iWakeVisits += WakeNeighboringParticles(x, y);
+	}
 
-				mapping.second->HandleFireProperties();
+	const PARTICLE_TYPE eParticleType = static_cast<PARTICLE_TYPE>(apParticle->QType());
+	sf::Color cCol = (apParticle->QIsOnFire() && !IS_LIQUID_CHECK(eParticleType)) ? COLOR_FIRE : GetParticleColor(eParticleType, iNewX, iNewY, !bHasMoved);
+	if (IsParticleOnEdge(iNewX, iNewY))
+	{
+		cCol.a = 170;
+	}
+	arCanvas.setPixel(iNewX, iNewY, cCol);
 
-				// If the particle is on fire, we need to heat the surroundings
-				if (mapping.second->QIsOnFire())
+	RefreshActiveState(apParticle);
+
+	if (apParticle->QHasLifetimeExpired())
+	{
+		arResults.expiredIDs.push_back(apParticle->QID());
+	}
+}
+
+/// <summary>
+/// Updates a particle found while itterating over a chunk, or gathers it into its class's batch when batching by class
+/// </summary>
+/// <param name="apParticle">Particle to update</param>
+/// <param name="arCanvas">Canvas to draw to</param>
+/// <param name="arResults">Results of the chunk this particle is being ticked in</param>
+void ParticleSimulation::UpdateOrBatchParticle(Particle* apParticle, sf::Image& arCanvas, ChunkTickResults& arResults)
+{
+	if (bClassBatching)
+	{
+		arResults.classBatches[static_cast<int>(apParticle->QClass())].push_back(apParticle);
+	}
+	else
+	{
+		TickParticle(apParticle, arCanvas, arResults);
+	}
+}
+
+/// <summary>
+/// Updates every particle gathered into one class's batch, timing the whole batch
+/// </summary>
+/// <param name="arCanvas">Canvas to draw to</param>
+/// <param name="arResults">Results of the chunk the batch was gathered from</param>
+/// <remarks>Particles already updated this tick are skipped, such as those displaced into a cell that was updated after them.
+/// Every particle in the batch is the particle object MaterialClassTraits binds to eClass, so its behaviours are called directly.</remarks>
+template <PARTICLE_CLASS eClass>
+void ParticleSimulation::TickClassBatch(sf::Image& arCanvas, ChunkTickResults& arResults)
+{
+	using T = typename MaterialClassTraits<eClass>::ParticleType;
+
+	std::vector<Particle*>& rBatch = arResults.classBatches[static_cast<int>(eClass)];
+	if (rBatch.empty())
+	{
+		return;
+	}
+
+	const auto tStart = std::chrono::steady_clock::now();
+	for (Particle* pParticle : rBatch)
+	{
+		if (pParticle->QLastUpdatedTick() != uiTickEpoch)
+		{
+			TickParticle(static_cast<T*>(pParticle), arCanvas, arResults);
+		}
+	}
+	arResults.classTickNanoseconds[static_cast<int>(eClass)] += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - tStart).count();
+	rBatch.clear();
+}
+
+/// <summary>
+/// Updates the batches gathered while itterating over a chunk, one class at a time
+/// </summary>
+/// <param name="arCanvas">Canvas to draw to</param>
+/// <param name="arResults">Results of the chunk the batches were gathered from</param>
+/// <remarks>Each batch keeps the order its particles were found in. Falling classes go first, so gases rise through the space they leave.</remarks>
+void ParticleSimulation::TickClassBatches(sf::Image& arCanvas, ChunkTickResults& arResults)
+{
+	TickClassBatch<PARTICLE_CLASS::POWDER>(arCanvas, arResults);
+	TickClassBatch<PARTICLE_CLASS::LIQUID>(arCanvas, arResults);
+	TickClassBatch<PARTICLE_CLASS::GAS>(arCanvas, arResults);
+	TickClassBatch<PARTICLE_CLASS::SOLID>(arCanvas, arResults);
+}
+
+/// <summary>
+/// Itterates over the dirty cells of a single chunk, updating any particles within them
+/// </summary>
+/// <param name="aiChunkID">Index of the chunk to itterate over</param>
+/// <param name="arCanvas">Canvas to draw to</param>
+/// <remarks>Only safe to run alongside chunks that are not adjacent to this one - a particle can only reach cells in its own and neighboring chunks.
+/// Results are written to this chunk's slot in chunkTickResults, and gathered by Tick once every phase is complete.</remarks>
+void ParticleSimulation::TickChunk(int aiChunkID, sf::Image* arCanvas)
+{
+	if (!arCanvas || bSleepingChunks[aiChunkID])
+	{
+		return;
+	}
+
+	ChunkTickResults& rResults = chunkTickResults[aiChunkID];
+	const ChunkRect& rRect = chunkUpdateRects[aiChunkID];
+	for (int y = rRect.iMaxY; y >= rRect.iMinY; --y)
+	{
+		for (int x = rRect.iMinX; x <= rRect.iMaxX; ++x)
+		{
+			++rResults.iCellVisits;
+
+			// Particles that moved into this cell from elsewhere have already been updated
+			Particle* pParticle = GetParticleFromMap(particleIDMap(x, y));
+			if (pParticle && pParticle->QLastUpdatedTick() != uiTickEpoch)
+			{
+				UpdateOrBatchParticle(pParticle, *arCanvas, rResults);
+			}
+		}
+	}
+
+	if (bClassBatching)
+	{
+		TickClassBatches(*arCanvas, rResults);
+	}
+}
+
+/// <summary>
+/// Redraws any cells in a chunk that changed this tick, but were not drawn while updating particles
+/// </summary>
+/// <param name="aiChunkID">Index of the chunk to redraw</param>
+/// <param name="arCanvas">Canvas to draw to</param>
+/// <remarks>Covers both the cells processed this tick, and those marked dirty for the next - such as cells emptied by a moving particle.</remarks>
+void ParticleSimulation::DrawChunk(int aiChunkID, sf::Image& arCanvas)
+{
+	const ChunkRect& rUpdateRect = chunkUpdateRects[aiChunkID];
+	const ChunkDirtyRect& rDirtyRect = chunkDirtyRects[aiChunkID];
+	const int iMinX = std::min<int>(rUpdateRect.iMinX, rDirtyRect.iMinX);
+	const int iMinY = std::min<int>(rUpdateRect.iMinY, rDirtyRect.iMinY);
+	const int iMaxX = std::max<int>(rUpdateRect.iMaxX, rDirtyRect.iMaxX);
+	const int iMaxY = std::max<int>(rUpdateRect.iMaxY, rDirtyRect.iMaxY);
+
+	ChunkTickResults& rResults = chunkTickResults[aiChunkID];
+	for (int y = iMinY; y <= iMaxY; ++y)
+	{
+		for (int x = iMinX; x <= iMaxX; ++x)
+		{
+			++rResults.iRedrawVisits;
+
+			Particle* pParticle = GetParticleFromMap(particleIDMap(x, y));
+			if (!pParticle)
+			{
+				arCanvas.setPixel(x, y, COLOR_CLEAR);
+			}
+			else if (pParticle->QLastUpdatedTick() != uiTickEpoch)
+			{
+				const PARTICLE_TYPE eParticleType = static_cast<PARTICLE_TYPE>(pParticle->QType());
+				sf::Color cCol = (pParticle->QIsOnFire() && !IS_LIQUID_CHECK(eParticleType)) ? COLOR_FIRE : GetParticleColor(eParticleType, x, y);
+				if (IsParticleOnEdge(x, y))
 				{
-					++iBurningParticles;
-					// TO-DO: Not thread safe, improve safety
-					auto HeatSurroundingsFunctor = [this](int aiX, int aiY, int aiTempStep)
-						{
-							if (IsPointWithinSimulation(aiX, aiY))
-							{
-								Particle* pParticle = GetParticleFromMap(particleIDMap[aiX][aiY]).get();
-								if (pParticle)
-								{
-									pParticle->IncreaseTemperature(aiTempStep);
-								}
-							}
-						};
-
-					const int iIgnitionStep = mapping.second->QTemperature() * 0.05f;	// TO-DO: Replace this with a value in the particle itself
-					HeatSurroundingsFunctor(x + 1, y, iIgnitionStep);
-					HeatSurroundingsFunctor(x - 1, y, iIgnitionStep);
-					HeatSurroundingsFunctor(x, y + 1, iIgnitionStep);
-					HeatSurroundingsFunctor(x, y - 1, iIgnitionStep);
+					cCol.a = 170;
 				}
+				arCanvas.setPixel(x, y, cCol);
+			}
+		}
+	}
+}
+
+/// <summary>
+/// Force wakes every particle in a chunk, and marks the whole chunk as dirty
+/// </summary>
+/// <param name="aiChunkID">Index of the chunk to wake</param>
+void ParticleSimulation::WakeChunk(int aiChunkID)
+{
+	const int iMinX = (aiChunkID % iChunkCountX) * chunkSize;
+	const int iMinY = (aiChunkID / iChunkCountX) * chunkSize;
+	for (int y = iMinY; y < iMinY + chunkSize; ++y)
+	{
+		for (int x = iMinX; x < iMinX + chunkSize; ++x)
+		{
+			Particle* pParticle = GetParticleFromMap(particleIDMap(x, y));
+			if (pParticle)
+			{
+				pParticle->ForceWake();
+				RefreshActiveState(pParticle);
+				++iPixelsVisitted_Total;	// Wake chunk pixel visits
+				++iPixelsVisitted_WakeChunk;
+			}
+		}
+	}
+
+	MarkCellDirty(iMinX, iMinY);
+	MarkCellDirty(iMinX + chunkSize - 1, iMinY + chunkSize - 1);
+}
 
-				if (!bForceFullUpdate)
+/// <summary>
+/// Wakes every chunk, so the whole simulation is processed and redrawn next tick
+/// </summary>
+/// <remarks>In sparse worlds, only chunks with storage allocated are woken - the rest hold no particles.</remarks>
+void ParticleSimulation::WakeAllChunks()
+{
+	for (int i = 0; i < iChunkCount; ++i)
+	{
+		if (!particleIDMap.QSparse() || particleIDMap.QBlockAllocated(i))
+		{
+			WakeChunk(i);
+		}
+	}
+}
+
+/// <summary>
+/// Frees the storage of chunks in a sparse world that have stayed asleep for sparseChunkReleaseTicks, and hold no particles
+/// </summary>
+/// <remarks>Only checks sparseChunkReleaseScanCount chunks per call, picking up where the last call left off.
+/// Must be called while no chunks are being ticked.</remarks>
+void ParticleSimulation::ReleaseEmptyChunks()
+{
+	const int iScanCount = std::min(sparseChunkReleaseScanCount, iChunkCount);
+	for (int i = 0; i < iScanCount; ++i)
+	{
+		const int iChunkID = iReleaseScanChunk;
+		iReleaseScanChunk = (iReleaseScanChunk + 1) % iChunkCount;
+
+		if (!particleIDMap.QBlockAllocated(iChunkID) || chunkDirtyRects[iChunkID].bQueued || uiTickEpoch - chunkLastAwakeTick[iChunkID] < sparseChunkReleaseTicks)
+		{
+			continue;
+		}
+
+		if (particleIDMap.ReleaseBlockIfEmpty(iChunkID))
+		{
+			particleHeatMap.ReleaseBlockIfEmpty(iChunkID);
+		}
+		else
+		{
+			// Still occupied, so don't check it again until it has been idle for another full period
+			chunkLastAwakeTick[iChunkID] = uiTickEpoch;
+		}
+	}
+}
+
+/// <summary>
+/// Pages out chunks that have left the streaming radius, and spawns the particles of chunks the chunk store has finished reading
+/// </summary>
+/// <remarks>Never waits on the chunk store. At most streamingChunksPerTick chunks are paged each way per call, with the rest left for later ticks.</remarks>
+void ParticleSimulation::UpdateStreaming()
+{
+	if (!bStreaming)
+	{
+		return;
+	}
+
+	int iPagedOut = 0;
+	while (!pendingPageOuts.empty() && iPagedOut < streamingChunksPerTick)
+	{
+		const int iChunkID = pendingPageOuts.back();
+		pendingPageOuts.pop_back();
+
+		// The focus may have moved back towards the chunk since it was queued
+		if (chunkResidency[iChunkID] == CHUNK_RESIDENCY::RESIDENT && !IsChunkWithinStreamingRadius(iChunkID))
+		{
+			PageOutChunk(iChunkID);
+			++iPagedOut;
+		}
+	}
+
+	chunkStore->CollectLoaded(pendingPageIns);
+	int iPagedIn = 0;
+	size_t uiProcessed = 0;
+	for (; uiProcessed < pendingPageIns.size() && iPagedIn < streamingChunksPerTick; ++uiProcessed)
+	{
+		const StoredChunk& rChunk = pendingPageIns[uiProcessed];
+		const int iChunkID = rChunk.iChunkID;
+		if (chunkResidency[iChunkID] != CHUNK_RESIDENCY::PAGING_IN)
+		{
+			continue;	// Forgotten by ResetSimulation while loading
+		}
+		if (!IsChunkWithinStreamingRadius(iChunkID))
+		{
+			// Left the radius while loading. Its file is only erased once spawned, so it is still stored.
+			SetChunkResidency(iChunkID, CHUNK_RESIDENCY::PAGED_OUT);
+			continue;
+		}
+
+		SetChunkResidency(iChunkID, CHUNK_RESIDENCY::RESIDENT);
+		for (const ParticleSnapshot& snap : rChunk.particles)
+		{
+			SpawnParticle(snap.x, snap.y, snap.tType);
+			Particle* pParticle = GetParticleFromMap(particleIDMap(snap.x, snap.y));
+			if (pParticle)
+			{
+				pParticle->IncreaseTemperature(snap.iTemp - pParticle->QTemperature());
+			}
+		}
+		chunkStore->Erase(iChunkID);
+
+		// Particles resting against the chunk's edge were resting against the edge of the simulation, and may now be free to move
+		const int iChunkX = iChunkID % iChunkCountX;
+		const int iChunkY = iChunkID / iChunkCountX;
+		for (int y = std::max(0, iChunkY - 1); y <= std::min(iChunkCountY - 1, iChunkY + 1); ++y)
+		{
+			for (int x = std::max(0, iChunkX - 1); x <= std::min(iChunkCountX - 1, iChunkX + 1); ++x)
+			{
+				const int iNeighborID = (y * iChunkCountX) + x;
+				if (iNeighborID != iChunkID && chunkResidency[iNeighborID] == CHUNK_RESIDENCY::RESIDENT)
 				{
-					const PARTICLE_TYPE eParticleType = static_cast<PARTICLE_TYPE>(mapping.second->QType());
-					sf::Color cCol = (mapping.second->QIsOnFire() && !IS_LIQUID_CHECK(eParticleType)) ? COLOR_FIRE : GetParticleColor(eParticleType, x, y, !bHasMoved);
-					if (IsParticleOnEdge(x, y))
-					{
-						cCol.a = 170;
-					}
-					//sf::Color cCol = mapping.second->QResting() ? sf::Color(180, 180, 180) : sf::Color(255, 255, 255);
-					arCanvas.setPixel(x, y, cCol);
+					WakeChunk(iNeighborID);
 				}
+			}
+		}
+		++iPagedIn;
+	}
+	pendingPageIns.erase(pendingPageIns.begin(), pendingPageIns.begin() + uiProcessed);
+}
+
+/// <summary>
+/// Removes every particle from a chunk, queueing them to be written to the chunk store, and stops simulating the chunk
+/// </summary>
+/// <param name="aiChunkID">Index of the chunk to page out</param>
+void ParticleSimulation::PageOutChunk(int aiChunkID)
+{
+	StoredChunk chunk;
+	chunk.iChunkID = aiChunkID;
+
+	const int iMinX = (aiChunkID % iChunkCountX) * chunkSize;
+	const int iMinY = (aiChunkID / iChunkCountX) * chunkSize;
+	for (int x = iMinX; x < iMinX + chunkSize; ++x)
+	{
+		for (int y = iMinY; y < iMinY + chunkSize; ++y)
+		{
+			const int iParticleID = particleIDMap(x, y);
+			Particle* pParticle = GetParticleFromMap(iParticleID);
+			if (!pParticle)
+			{
+				continue;
+			}
+
+			if (!pParticle->QHasLifetimeExpired())
+			{
+				chunk.particles.push_back({ static_cast<PARTICLE_TYPE>(pParticle->QType()), static_cast<unsigned int>(x), static_cast<unsigned int>(y), pParticle->QTemperature() });
+			}
+			if (pParticle->QCountedActive())
+			{
+				--iActiveParticles;
+			}
+			particleMap.Erase(iParticleID);
+			particleIDMap(x, y) = NULL_PARTICLE_ID;
+			UpdateCellOccupancy(x, y);
+		}
+	}
+
+	// Redraw the whole chunk before it stops being resident, clearing it from the canvas
+	MarkCellDirty(iMinX, iMinY);
+	MarkCellDirty(iMinX + chunkSize - 1, iMinY + chunkSize - 1);
+
+	if (chunk.particles.empty())
+	{
+		SetChunkResidency(aiChunkID, CHUNK_RESIDENCY::UNLOADED);
+	}
+	else
+	{
+		SetChunkResidency(aiChunkID, CHUNK_RESIDENCY::PAGED_OUT);
+		chunkStore->Save(std::move(chunk));
+	}
+}
+
+/// <summary>
+/// Returns true if a chunk is close enough to the focus chunk to be resident while streaming
+/// </summary>
+bool ParticleSimulation::IsChunkWithinStreamingRadius(int aiChunkID)
+{
+	return std::abs((aiChunkID % iChunkCountX) - iFocusChunkX) <= iStreamingRadius && std::abs((aiChunkID / iChunkCountX) - iFocusChunkY) <= iStreamingRadius;
+}
 
-				if (mapping.second->QHasLifetimeExpired())
-				{
-					expiredParticleIDs.push_back(mapping.first);
-					mapping.second.reset();
-				}
+/// <summary>
+/// Starts streaming the simulation. Only chunks within aiResidentRadius chunks of the focus are kept in memory and simulated. The rest are paged out to disk.
+/// </summary>
+/// <param name="asStoreDirectory">Directory to keep paged out chunks in. Created if it doesn't exist.</param>
+/// <param name="aiResidentRadius">Number of chunks either side of the focus chunk to keep resident</param>
+/// <remarks>Best used with a sparse simulation, so the storage of paged out chunks is freed. The focus starts in the centre of the simulation.
+/// Non-resident chunks act as the edge of the simulation - particles can't move, spawn or reach into them.</remarks>
+void ParticleSimulation::EnableStreaming(const std::string& asStoreDirectory, int aiResidentRadius)
+{
+	EndStreaming();
+
+	bStreaming = true;
+	sStreamingStoreDirectory = asStoreDirectory;
+	iStreamingRadius = std::max(0, aiResidentRadius);
+	iFocusChunkX = iChunkCountX / 2;
+	iFocusChunkY = iChunkCountY / 2;
+	chunkStore = std::make_unique<ChunkStore>(asStoreDirectory, iChunkCountX);
+	chunkResidency.reset(new CHUNK_RESIDENCY[iChunkCount]);
+
+	// Chunks outside the radius are paged out over the next few ticks. Those with no storage have nothing to page out.
+	iResidentChunks = iChunkCount;
+	for (int i = 0; i < iChunkCount; ++i)
+	{
+		chunkResidency[i] = CHUNK_RESIDENCY::RESIDENT;
+		if (!IsChunkWithinStreamingRadius(i))
+		{
+			if (particleIDMap.QSparse() && !particleIDMap.QBlockAllocated(i))
+			{
+				SetChunkResidency(i, CHUNK_RESIDENCY::UNLOADED);
+			}
+			else
+			{
+				pendingPageOuts.push_back(i);
 			}
 		}
-			
-		++iPixelsVisitted_Total;	// Pre-chunk pixel visits
-		++iPixelsVisitted_PreChunk;
-	}
-#ifdef USE_THREADED_CHUNKS
-	// Spin up chunk update threads
-	std::thread worker1([this, &arCanvas, &expiredParticleIDs]() { TickChunk(&chunkParticleMaps[0], &arCanvas, &expiredParticleIDs); });
-	++iChunksVisitted;
-	std::thread worker2([this, &arCanvas, &expiredParticleIDs]() { TickChunk(&chunkParticleMaps[1], &arCanvas, &expiredParticleIDs); });
-	++iChunksVisitted;
-	std::thread worker3([this, &arCanvas, &expiredParticleIDs]() { TickChunk(&chunkParticleMaps[2], &arCanvas, &expiredParticleIDs); });
-	++iChunksVisitted;
-	std::thread worker4([this, &arCanvas, &expiredParticleIDs]() { TickChunk(&chunkParticleMaps[3], &arCanvas, &expiredParticleIDs); });
-	++iChunksVisitted;
-	std::thread worker5([this, &arCanvas, &expiredParticleIDs]() { TickChunk(&chunkParticleMaps[4], &arCanvas, &expiredParticleIDs); });
-	++iChunksVisitted;
-	std::thread worker6([this, &arCanvas, &expiredParticleIDs]() { TickChunk(&chunkParticleMaps[5], &arCanvas, &expiredParticleIDs); });
-	++iChunksVisitted;
-	std::thread worker7([this, &arCanvas, &expiredParticleIDs]() { TickChunk(&chunkParticleMaps[6], &arCanvas, &expiredParticleIDs); });
-	++iChunksVisitted;
-	std::thread worker8([this, &arCanvas, &expiredParticleIDs]() { TickChunk(&chunkParticleMaps[7], &arCanvas, &expiredParticleIDs); });
-	++iChunksVisitted;
-	worker1.join();
-	worker2.join();
-	worker3.join();
-	worker4.join();
-	worker5.join();
-	worker6.join();
-	worker7.join();
-	worker8.join();
-
-	// Clear chunk smart pointer cache, releasing their refs
-	for (int i = 0; i < chunkCount; ++i)
-	{
-		for (std::pair<const int, std::shared_ptr<Particle>> mapping : chunkParticleMaps[i])
-		{
-			mapping.second.reset();
-		}
-		chunkParticleMaps[i].clear();
 	}
-#endif
+}
 
-	// After a tick, itterate over the particle map, and allow them to be updated again
-	for (std::pair<const int, std::shared_ptr<Particle>> mapping : particleMap)
+/// <summary>
+/// Moves the point streaming is centred on. Chunks entering the radius start paging in, and those leaving it are queued to be paged out.
+/// </summary>
+/// <param name="aiX">X position of the focus, in cells</param>
+/// <param name="aiY">Y position of the focus, in cells</param>
+void ParticleSimulation::SetStreamingFocus(int aiX, int aiY)
+{
+	const int iNewFocusX = std::min(std::max(aiX / chunkSize, 0), iChunkCountX - 1);
+	const int iNewFocusY = std::min(std::max(aiY / chunkSize, 0), iChunkCountY - 1);
+	if (!bStreaming || (iNewFocusX == iFocusChunkX && iNewFocusY == iFocusChunkY))
 	{
-		mapping.second->SetHasBeenUpdated(false);
-		++iPixelsVisitted_Total;	// Wake particle map visits
-		++iPixelsVisitted_AllowUpdate;
+		return;
 	}
 
-	// Reset chunks requiring updates
-	if (bRunFullTick)
+	const int iOldFocusX = iFocusChunkX;
+	const int iOldFocusY = iFocusChunkY;
+	iFocusChunkX = iNewFocusX;
+	iFocusChunkY = iNewFocusY;
+
+	// Only the chunks around the old and new focus can change residency
+	for (int y = std::max(0, iOldFocusY - iStreamingRadius); y <= std::min(iChunkCountY - 1, iOldFocusY + iStreamingRadius); ++y)
 	{
-		for (int i = 0; i < chunkCount; ++i)
+		for (int x = std::max(0, iOldFocusX - iStreamingRadius); x <= std::min(iChunkCountX - 1, iOldFocusX + iStreamingRadius); ++x)
 		{
-			bChunksNeedUpdating[i] = false;
+			const int iChunkID = (y * iChunkCountX) + x;
+			if (!IsChunkWithinStreamingRadius(iChunkID))
+			{
+				pendingPageOuts.push_back(iChunkID);
+			}
 		}
 	}
-
-	// During the course of a tick, we check if a particle has expired it's lifetime. These particles are collected in expiredParticleIDs.
-	// As our particle unordered_map stores particle objects as a shared pointer, all we need to do is erase their mapping from the
-	// map, and the memory is automatically freed.
-	for (int aiExpiredID : expiredParticleIDs)
+	for (int y = std::max(0, iFocusChunkY - iStreamingRadius); y <= std::min(iChunkCountY - 1, iFocusChunkY + iStreamingRadius); ++y)
 	{
-		if (GetParticleFromMap(aiExpiredID))
+		for (int x = std::max(0, iFocusChunkX - iStreamingRadius); x <= std::min(iChunkCountX - 1, iFocusChunkX + iStreamingRadius); ++x)
 		{
-			const int x = GetParticleFromMap(aiExpiredID)->QX();
-			const int y = GetParticleFromMap(aiExpiredID)->QY();
-
-			const PARTICLE_TYPE uiDeathParticleType = static_cast<PARTICLE_TYPE>(GetParticleFromMap(aiExpiredID)->QDeathParticleType());
-			bool bCanSpawnDeathParticle = IS_SOLID_CHECK(static_cast<PARTICLE_TYPE>(GetParticleFromMap(aiExpiredID)->QType())) || IS_LIQUID_CHECK(static_cast<PARTICLE_TYPE>(GetParticleFromMap(aiExpiredID)->QType()));
+			RequestChunkPageIn((y * iChunkCountX) + x);
+		}
+	}
+}
 
-			particleIDMap[x][y] = NULL_PARTICLE_ID;
+/// <summary>
+/// Stops streaming, discarding every chunk that isn't resident. Waits for the chunk store to finish any outstanding requests.
+/// </summary>
+void ParticleSimulation::EndStreaming()
+{
+	if (!bStreaming)
+	{
+		return;
+	}
 
-			// Remove reference from the main and chunk hashmaps
-			particleMap.erase(aiExpiredID);
+	// Discarded chunks become resident and empty, so unseal them
+	for (int i = 0; i < iChunkCount; ++i)
+	{
+		SetChunkResidency(i, CHUNK_RESIDENCY::RESIDENT);
+	}
 
-			if (bCanSpawnDeathParticle)
-			{
-				if (uiDeathParticleType != PARTICLE_TYPE::NONE)
-				{
-					SpawnParticle(x, y, uiDeathParticleType);
-				}
-			}
+	bStreaming = false;
+	chunkStore.reset();
+	chunkResidency.reset();
+	pendingPageOuts.clear();
+	pendingPageIns.clear();
+}
 
-			// Cache any chunks we need to notify as a result of this deletion
-			const int iParticleChunkID = GetChunkForPosition(x);
-			bChunksNeedUpdating[iParticleChunkID] = true;
-			if (iParticleChunkID < chunkCount)
-			{
-				bChunksNeedUpdating[iParticleChunkID + 1] = true;
-			}
-			if (iParticleChunkID > 0)
-			{
-				bChunksNeedUpdating[iParticleChunkID - 1] = true;
-			}
+/// <summary>
+/// Returns the number of chunks in memory. Every chunk is resident unless streaming.
+/// </summary>
+int ParticleSimulation::QResidentChunkCount()
+{
+	return bStreaming ? iResidentChunks : iChunkCount;
+}
 
-			++iPixelsVisitted_Total;	// Clean up expired pixel visits
-			++iPixelsVisitted_ExpiredCleanup;
+/// <summary>
+/// Wakes any resting particles whose support or flow could change now that a cell has been vacated
+/// </summary>
+/// <param name="aiX">The X position of the vacated cell.</param>
+/// <param name="aiY">The Y position of the vacated cell.</param>
+/// <returns>The number of particles woken.</returns>
+/// <remarks>Only reaches cells in the same or neighboring chunks, so is safe to call from any chunk's tick.</remarks>
+int ParticleSimulation::WakeNeighboringParticles(int aiX, int aiY)
+{
+	int iWokenParticles = 0;
+	for (int i = 0; i < wakeNeighborCount; ++i)
+	{
+		const int x = aiX + wakeNeighborOffsets[i][0];
+		const int y = aiY + wakeNeighborOffsets[i][1];
+		Particle* pNeighbor = GetParticleFromMap(particleIDMap(x, y));
+		if (pNeighbor && pNeighbor->QResting())
+		{
+			pNeighbor->ForceWake();
+			RefreshActiveState(pNeighbor);
+			MarkCellDirty(x, y);
+			++iWokenParticles;
 		}
 	}
-	expiredParticleIDs.clear();
+	return iWokenParticles;
+}
 
-	return bRunFullTick;
+/// <summary>
+/// Updates the active particle count if a particle has gone to rest or woken since it was last counted
+/// </summary>
+/// <remarks>Must be called after any change that can affect a particle's QResting. Safe to call from any chunk's tick.</remarks>
+void ParticleSimulation::RefreshActiveState(Particle* apParticle)
+{
+	const bool bActive = !apParticle->QResting();
+	if (bActive != apParticle->QCountedActive())
+	{
+		apParticle->SetCountedActive(bActive);
+		iActiveParticles += bActive ? 1 : -1;
+	}
 }
 
 /// <summary>
-/// Initializes any cached data for the simulation, such as the particle texture atlas
+/// Grows the dirty rectangle of the chunk containing a cell, so the cell is processed and redrawn next tick
 /// </summary>
-void ParticleSimulation::Initialize()
+/// <param name="aiX">The X position of the cell.</param>
+/// <param name="aiY">The Y position of the cell.</param>
+/// <remarks>The chunk is queued to be awake next tick the first time one of its cells is marked. Safe to call from any chunk's tick.
+/// The cell must be within the simulation - only cells holding, or just vacated by, a particle are marked.</remarks>
+void ParticleSimulation::MarkCellDirty(int aiX, int aiY)
 {
-	auto TextureLoaderFunctor = [&](PARTICLE_TYPE aeParticleType, std::string asFilepath)
-		{
-			sf::Image* img = new sf::Image();
-			if (img->loadFromFile(asFilepath))
-			{
-				particleTextureAtlas.emplace(aeParticleType, img);
-			}
-		};
+	const int iChunkID = GetChunkForPosition(aiX, aiY);
+	ChunkDirtyRect& rDirtyRect = chunkDirtyRects[iChunkID];
+	if (!rDirtyRect.bQueued.load(std::memory_order_relaxed) && !rDirtyRect.bQueued.exchange(true))
+	{
+		queuedChunkIDs[iQueuedChunkCount++] = iChunkID;
+	}
+	AtomicMin(rDirtyRect.iMinX, aiX);
+	AtomicMin(rDirtyRect.iMinY, aiY);
+	AtomicMax(rDirtyRect.iMaxX, aiX);
+	AtomicMax(rDirtyRect.iMaxY, aiY);
+}
 
-	// Load all particle textures into the atlas here
-	TextureLoaderFunctor(PARTICLE_TYPE::COAL, "Assets\\Sprites\\T_Coal.png");
-	TextureLoaderFunctor(PARTICLE_TYPE::SAND, "Assets\\Sprites\\T_Sand.png");
-	TextureLoaderFunctor(PARTICLE_TYPE::LEAVES, "Assets\\Sprites\\T_Leaves.png");
-	TextureLoaderFunctor(PARTICLE_TYPE::WOOD, "Assets\\Sprites\\T_Wood.png");
-	TextureLoaderFunctor(PARTICLE_TYPE::ROCK, "Assets\\Sprites\\T_Stone.png");
+/// <summary>
+/// Brings a cell's bits in the column and row occupancy masks up to date with the particle now in it
+/// </summary>
+/// <remarks>Must be called after every change to the particle held by a cell within the simulation, unless FlipCellOccupancy has been. Safe to call from any chunk's tick.</remarks>
+void ParticleSimulation::UpdateCellOccupancy(int aiX, int aiY)
+{
+	const bool bOccupied = GetParticleFromMap(particleIDMap(aiX, aiY)) != nullptr;
+	SetColumnBits(columnOccupancy[(static_cast<size_t>(aiY / chunkSize) * iWidth) + aiX], 1u << (aiY % chunkSize), bOccupied);
+	SetColumnBits(rowOccupancy[(static_cast<size_t>(aiX / chunkSize) * iHeight) + aiY], 1u << (aiX % chunkSize), bOccupied);
 }
 
 /// <summary>
-/// Itterates over a single chunked area of the simulation
+/// Flips the bits of two cells in the occupancy masks, for a particle moving into an empty cell without reading either cell back
 /// </summary>
-/// <param name="auiChunkID">Index of the chunk to itterate over</param>
-/// <param name="arCanvas">Canvas to draw to</param>
-/// <param name="arExpiredIDs">Expired IDs vector - used to clean up expired particles at the end of the wider simulation tick</param>
-/// <remarks>Note: this is not currently considered thread safe. If these were to be turned into threads as-is, we'd have each thread accessing the particleIDMap, and the hashmap, all the time.</remarks>
-void ParticleSimulation::TickChunk(std::unordered_map<int, std::shared_ptr<Particle>>* amParticleMap, sf::Image* arCanvas, std::vector<int>* arExpiredIDs)
+/// <remarks>The first cell must be occupied and the second empty, or the other way around. Safe to call from any chunk's tick.</remarks>
+void ParticleSimulation::FlipCellOccupancy(int aiX, int aiY, int aiNewX, int aiNewY)
 {
-#ifdef USE_THREADED_CHUNKS
-	if (!amParticleMap || !arCanvas || !arExpiredIDs)
+	FlipMaskBits(columnOccupancy.get(), (static_cast<size_t>(aiY / chunkSize) * iWidth) + aiX, 1u << (aiY % chunkSize),
+		(static_cast<size_t>(aiNewY / chunkSize) * iWidth) + aiNewX, 1u << (aiNewY % chunkSize));
+	FlipMaskBits(rowOccupancy.get(), (static_cast<size_t>(aiX / chunkSize) * iHeight) + aiY, 1u << (aiX % chunkSize),
+		(static_cast<size_t>(aiNewX / chunkSize) * iHeight) + aiNewY, 1u << (aiNewX % chunkSize));
+}
+
+/// <summary>
+/// Marks every cell as empty in the column and row occupancy masks
+/// </summary>
+void ParticleSimulation::ClearCellOccupancy()
+{
+	const size_t uiColumnCount = static_cast<size_t>(iChunkCountY) * iWidth;
+	for (size_t i = 0; i < uiColumnCount; ++i)
 	{
-		return;
+		columnOccupancy[i].store(0, std::memory_order_relaxed);
 	}
+	const size_t uiRowCount = static_cast<size_t>(iChunkCountX) * iHeight;
+	for (size_t i = 0; i < uiRowCount; ++i)
+	{
+		rowOccupancy[i].store(0, std::memory_order_relaxed);
+	}
+}
 
-	for (std::pair<const int, std::shared_ptr<Particle>> mapping : *amParticleMap)
+/// <summary>
+/// Counts the unoccupied cells past a cell along its row or column, using the occupancy masks rather than particleIDMap
+/// </summary>
+/// <param name="aiX">The position of the cell on the X axis.</param>
+/// <param name="aiY">The position of the cell on the Y axis.</param>
+/// <param name="aiStepX">The direction to count in on the X axis. Must be 0 if aiStepY isn't.</param>
+/// <param name="aiStepY">The direction to count in on the Y axis. Must be 0 if aiStepX isn't.</param>
+/// <param name="aiLength">The most cells to count.</param>
+/// <returns>The number of cells that can be moved through before the first occupied cell, the edge of the simulation, or a non-resident chunk.</returns>
+/// <remarks>The cell itself is ignored. Columns use the column masks and rows the row masks, finding their first obstacle with a bit scan of each chunk's mask,
+/// so a probe shorter than a chunk reads at most two.</remarks>
+int ParticleSimulation::QFreeCellCount(int aiX, int aiY, int aiStepX, int aiStepY, int aiLength)
+{
+	// Probes run along the mask's axis, and pick one mask in each chunk by their position across it
+	const bool bVertical = aiStepY != 0;
+	const int iStep = bVertical ? aiStepY : aiStepX;
+	const int iStart = bVertical ? aiY : aiX;
+	const int iAcross = bVertical ? aiX : aiY;
+	const std::atomic<uint32_t>* pMasks = bVertical ? columnOccupancy.get() : rowOccupancy.get();
+	const size_t uiMasksPerChunk = static_cast<size_t>(bVertical ? iWidth : iHeight);
+
+	// The cell past the end of the probe, or past the edge of the simulation, is the furthest obstacle
+	const int iEnd = iStep > 0 ? std::min(iStart + aiLength + 1, bVertical ? iHeight : iWidth) : std::max(iStart - aiLength - 1, -1);
+	int iObstacle = iEnd;
+
+	const int iStartChunk = iStart / chunkSize;
+	for (int iChunk = iStartChunk; ; iChunk += iStep)
 	{
-		if (mapping.second)
+		const int iChunkStart = iChunk * chunkSize;
+		const int iChunkFirst = iStep > 0 ? iChunkStart : iChunkStart + chunkSize - 1;
+		if (iStep > 0 ? iChunkFirst >= iEnd : iChunkFirst <= iEnd)
 		{
-			ParticleMapLock.lock();
-			const int x = mapping.second->QX();
-			const int y = mapping.second->QY();
-
-			if (!mapping.second->QResting())
-			{
-				if (!mapping.second->QHasBeenUpdatedThisTick())
-				{
-					mapping.second->HandleMovement();
-					mapping.second->SetHasBeenUpdated(true);
-				}
-			}
-
-			mapping.second->HandleFireProperties();
+			break;
+		}
 
-			// If the particle is on fire, we need to heat the surroundings
-			if (mapping.second->QIsOnFire())
-			{
-				++iBurningParticles;
-				// TO-DO: Not thread safe, improve safety
-				auto HeatSurroundingsFunctor = [this](int aiX, int aiY, int aiTempStep)
-					{
-						if (IsPointWithinSimulation(aiX, aiY))
-						{
-							Particle* pParticle = GetParticleFromMap(particleIDMap[aiX][aiY]).get();
-							if (pParticle)
-							{
-								pParticle->IncreaseTemperature(aiTempStep);
-							}
-						}
-					};
-
-				const int iIgnitionStep = mapping.second->QTemperature() * 0.05f;	// TO-DO: Replace this with a value in the particle itself
-				HeatSurroundingsFunctor(x + 1, y, iIgnitionStep);
-				HeatSurroundingsFunctor(x - 1, y, iIgnitionStep);
-				HeatSurroundingsFunctor(x, y + 1, iIgnitionStep);
-				HeatSurroundingsFunctor(x, y - 1, iIgnitionStep);
-			}
+		// Non-resident chunks are sealed with walls, so the probe stops at their edge
+		if (chunkResidency && iChunk != iStartChunk
+			&& chunkResidency[bVertical ? GetChunkForPosition(iAcross, iChunkStart) : GetChunkForPosition(iChunkStart, iAcross)] != CHUNK_RESIDENCY::RESIDENT)
+		{
+			iObstacle = iChunkFirst;
+			break;
+		}
 
-			sf::Color cCol = mapping.second->QIsOnFire() ? COLOR_FIRE : mapping.second->QColor();
-			if (IsParticleOnEdge(x, y))
-			{
-				cCol.a = 200;
-			}
-			arCanvas->setPixel(x, y, cCol); 
-			
-			if (mapping.second->QHasLifetimeExpired())
-			{
-				ExpiredIDLock.lock();
-				arExpiredIDs->push_back(mapping.first);
-				ExpiredIDLock.unlock();
-				mapping.second.reset();
-			}
-			ParticleMapLock.unlock();
+		uint32_t uiCells = pMasks[(static_cast<size_t>(iChunk) * uiMasksPerChunk) + iAcross].load(std::memory_order_relaxed);
+		if (iChunk == iStartChunk)
+		{
+			// Only cells past the start count
+			const uint32_t uiStartBit = iStart % chunkSize;
+			uiCells &= iStep > 0 ? ~((2u << uiStartBit) - 1) : (1u << uiStartBit) - 1;
+		}
+		if (uiCells != 0)
+		{
+			iObstacle = iChunkStart + (iStep > 0 ? LowestSetBit(uiCells) : HighestSetBit(uiCells));
+			break;
 		}
-		++iPixelsVisitted_Total; // Chunk tick pixel visits
-		++iPixelsVisitted_ChunkTick;
 	}
-#endif
+
+	return std::min(abs(iObstacle - iStart) - 1, aiLength);
 }
 
 /// <summary>
@@ -426,41 +1140,49 @@ void ParticleSimulation::TickChunk(std::unordered_map<int, std::shared_ptr<Parti
 /// <param name="aiNewX">The X position to move the particle to.</param>
 /// <param name="aiNewY">The Y position to move the particle to.</param>
 /// <returns>True if the move could be completed, false otherwise.</returns>
+/// <remarks>The new position must be a neighbor of the particle, or a point found by LineTest. Positions past the edge of the simulation are walls, so are never moved into.</remarks>
 bool ParticleSimulation::RequestParticleMove(int aiRequesterID, unsigned int aiNewX, unsigned int aiNewY)
 {
 	bool bRequestAllowed = false;
 
-	if (IsPointWithinSimulation(aiNewX, aiNewY))
+	const int iTargetID = particleIDMap(aiNewX, aiNewY);
+	if (iTargetID != WALL_PARTICLE_ID)
 	{
-		if (GetParticleFromMap(aiRequesterID))
+		Particle* pRequester = GetParticleFromMap(aiRequesterID);
+		if (pRequester)
 		{
 			// Check if the slot is free
 			// If so, move the particle into a new slow
 			// If not, we need to check for any special cases
-			if (GetParticleFromMap(particleIDMap[aiNewX][aiNewY]))
+			Particle* pTarget = GetParticleFromMap(iTargetID);
+			if (pTarget)
 			{
-				// Special case: powders can displace water, swapping with them
-				if (IsParticleDisplacementAllowed(aiRequesterID, particleIDMap[aiNewX][aiNewY]))
+				// Special case: heavier materials can displace lighter ones, swapping with them
+				if (materialRegistry.QCanDisplace(static_cast<PARTICLE_TYPE>(pRequester->QType()), static_cast<PARTICLE_TYPE>(pTarget->QType())))
 				{
-					int x = GetParticleFromMap(aiRequesterID)->QX();
-					int y = GetParticleFromMap(aiRequesterID)->QY();
+					int x = pRequester->QX();
+					int y = pRequester->QY();
 
-					const unsigned int uiDisplacedID = particleIDMap[aiNewX][aiNewY];
+					const unsigned int uiDisplacedID = iTargetID;
 
-					// Finally, swap the particles
-					particleIDMap[aiNewX][aiNewY] = aiRequesterID;
-					particleIDMap[x][y] = uiDisplacedID;
+					// Finally, swap the particles. The requester updates its own position, but the displaced particle needs moving here.
+					particleIDMap(aiNewX, aiNewY) = aiRequesterID;
+					particleIDMap(x, y) = uiDisplacedID;
+					pTarget->SetPosition(x, y);
+					MarkCellDirty(x, y);
 					bRequestAllowed = true;
 				}
 			}
 			else
 			{
-				int x = GetParticleFromMap(aiRequesterID)->QX();
-				int y = GetParticleFromMap(aiRequesterID)->QY();
-
-				// Finally, move the particle
-				particleIDMap[aiNewX][aiNewY] = aiRequesterID;
-				particleIDMap[x][y] = NULL_PARTICLE_ID;
+				int x = pRequester->QX();
+				int y = pRequester->QY();
+
+				// Finally, move the particle. In sparse worlds, the particle may be moving into a chunk with no storage yet.
+				particleIDMap.Allocate(aiNewX, aiNewY);
+				particleIDMap(aiNewX, aiNewY) = aiRequesterID;
+				particleIDMap(x, y) = NULL_PARTICLE_ID;
+				FlipCellOccupancy(x, y, aiNewX, aiNewY);
 				bRequestAllowed = true;
 			}
 		}
@@ -474,34 +1196,42 @@ bool ParticleSimulation::RequestParticleMove(int aiRequesterID, unsigned int aiN
 /// <param name="aiX">The X position to spawn the new particle.</param>
 /// <param name="aiY">The Y position to spawn the new particle.</param>
 /// <param name="aeParticleType">The type of particle to spawn.</param>
-/// <remarks>No particle will be spawned if the given position is not within the simulation; nor if that position is already taken.</remarks>
+/// <remarks>No particle will be spawned if the given position is not within the simulation; nor if that position is already taken.
+/// Sparse worlds can have more cells than the slot map can hold particles, so no particle will be spawned once maxSimulationCellCount are alive.</remarks>
 void ParticleSimulation::SpawnParticle(unsigned int aiX, unsigned int aiY, PARTICLE_TYPE aeParticleType)
 {
-	if (IsPointWithinSimulation(aiX, aiY))
+	if (IsPointWithinSimulation(aiX, aiY) && particleMap.Size() < maxSimulationCellCount)
 	{
-		Particle* pParticle = GetParticleFromMap(particleIDMap[aiX][aiY]).get();
+		Particle* pParticle = GetParticleFromMap(particleIDMap(aiX, aiY));
 
-		if (!pParticle && particleIDMap[aiX][aiY] == NULL_PARTICLE_ID)
+		if (!pParticle && particleIDMap(aiX, aiY) == NULL_PARTICLE_ID)
 		{
-			if (IS_GAS_CHECK(aeParticleType))
-			{
-				particleMap.insert(std::make_pair(iUniqueParticleID, CREATE_PARTICLE_PTR(ParticleGas, aeParticleType, gasPropertiesMap.at(aeParticleType))));
-			}
-			if (IS_LIQUID_CHECK(aeParticleType))
-			{
-				particleMap.insert(std::make_pair(iUniqueParticleID, CREATE_PARTICLE_PTR(ParticleLiquid, aeParticleType, liquidPropertiesMap.at(aeParticleType))));
-			}
-			if (IS_POWDER_CHECK(aeParticleType))
-			{
-				particleMap.insert(std::make_pair(iUniqueParticleID, CREATE_PARTICLE_PTR(ParticlePowder, aeParticleType, powderPropertiesMap.at(aeParticleType))));
-			}
-			if (IS_SOLID_CHECK(aeParticleType))
+			particleIDMap.Allocate(aiX, aiY);
+			particleHeatMap.Allocate(aiX, aiY);
+
+			int iNewParticleID = NULL_PARTICLE_ID;
+			switch (materialRegistry.QClass(aeParticleType))
 			{
-				particleMap.insert(std::make_pair(iUniqueParticleID, CREATE_PARTICLE_PTR(ParticleSolid, aeParticleType, solidPropertiesMap.at(aeParticleType))));
+			case PARTICLE_CLASS::GAS:
+				iNewParticleID = EMPLACE_PARTICLE(ParticleGas, gasPool, aeParticleType, &gasPropertiesTable[aeParticleType]);
+				break;
+			case PARTICLE_CLASS::LIQUID:
+				iNewParticleID = EMPLACE_PARTICLE(ParticleLiquid, liquidPool, aeParticleType, &liquidPropertiesTable[aeParticleType]);
+				break;
+			case PARTICLE_CLASS::POWDER:
+				iNewParticleID = EMPLACE_PARTICLE(ParticlePowder, powderPool, aeParticleType, &powderPropertiesTable[aeParticleType]);
+				break;
+			case PARTICLE_CLASS::SOLID:
+				iNewParticleID = EMPLACE_PARTICLE(ParticleSolid, solidPool, aeParticleType, &solidPropertiesTable[aeParticleType]);
+				break;
+			default:
+				break;
 			}
 
-			particleIDMap[aiX][aiY] = iUniqueParticleID;
-			++iUniqueParticleID;
+			particleIDMap(aiX, aiY) = iNewParticleID;
+			UpdateCellOccupancy(aiX, aiY);
+			MarkCellDirty(aiX, aiY);
+			RefreshActiveState(GetParticleFromMap(iNewParticleID));
 		}
 	}
 }
@@ -513,7 +1243,8 @@ void ParticleSimulation::DestroyParticle(unsigned int aiX, unsigned int aiY)
 {
 	if (IsPointWithinSimulation(aiX, aiY) && IsSpaceOccupied(aiX, aiY))
 	{
-		GetParticleFromMap(particleIDMap[aiX][aiY])->ForceExpire();
+		GetParticleFromMap(particleIDMap(aiX, aiY))->ForceExpire();
+		MarkCellDirty(aiX, aiY);
 	}
 }
 
@@ -526,7 +1257,10 @@ void ParticleSimulation::IgniteParticle(unsigned int aiX, unsigned int aiY)
 {
 	if (IsPointWithinSimulation(aiX, aiY) && IsSpaceOccupied(aiX, aiY))
 	{
-		GetParticleFromMap(particleIDMap[aiX][aiY])->Ignite();
+		Particle* pTarget = GetParticleFromMap(particleIDMap(aiX, aiY));
+		pTarget->Ignite();
+		RefreshActiveState(pTarget);
+		MarkCellDirty(aiX, aiY);
 	}
 }
 
@@ -536,12 +1270,19 @@ void ParticleSimulation::IgniteParticle(unsigned int aiX, unsigned int aiY)
 /// <param name="aiX">The X position of the target particle.</param>
 /// <param name="aiY">The Y position of the target particle.</param>
 /// <returns>True if the particle was extinguished, false otherwise.</returns>
+/// <remarks>Only called on a particle's neighbors, which are at most a cell into the border, so needs no bounds check.</remarks>
 bool ParticleSimulation::ExtinguishParticle(unsigned int aiX, unsigned int aiY)
 {
 	bool bRetVal = false;
-	if (IsPointWithinSimulation(aiX, aiY) && IsSpaceOccupied(aiX, aiY))
+	if (IsSpaceOccupied(aiX, aiY))
 	{
-		GetParticleFromMap(particleIDMap[aiX][aiY])->Extinguish();
+		Particle* pTarget = GetParticleFromMap(particleIDMap(aiX, aiY));
+		if (pTarget->QIsOnFire())
+		{
+			MarkCellDirty(aiX, aiY);
+		}
+		pTarget->Extinguish();
+		RefreshActiveState(pTarget);
 	}
 	return bRetVal;
 }
@@ -562,21 +1303,15 @@ bool ParticleSimulation::ExtinguishNeighboringParticles(unsigned int aiX, unsign
 /// </summary>
 /// <param name="aiX">The X position of the target particle.</param>
 /// <param name="aiY">The Y position of the target particle.</param>
+/// <remarks>Walls never refer to a particle, so positions in the border read as unoccupied, as positions outside the simulation always have.
+/// Must be within simulationBorder cells of the simulation.</remarks>
 bool ParticleSimulation::IsSpaceOccupied(unsigned int aiX, unsigned int aiY)
 {
-	bool bRetVal = false;
-	if (IsPointWithinSimulation(aiX, aiY))
-	{
-		if (GetParticleFromMap(particleIDMap[aiX][aiY]).get())
-		{
-			bRetVal = true;
-		}
-	}
-	return bRetVal;
+	return GetParticleFromMap(particleIDMap(aiX, aiY)) != nullptr;
 }
 
 /// <summary>
-/// Using a DDA algorithm, trace a line between the start and end points, checking if any of the points traversed are occupied.
+/// Trace a line between the start and end points, checking if any of the points traversed are occupied.
 /// </summary>
 /// <param name="aiRequesterID">The ID of the particle that is moving.</param>
 /// <param name="aiStartX">The start position of the line on the X axis.</param>
@@ -586,76 +1321,121 @@ bool ParticleSimulation::IsSpaceOccupied(unsigned int aiX, unsigned int aiY)
 /// <param name="aiHitPointX">The out variable for where the particle can move without collision on the X axis.</param>
 /// <param name="aiHitPointY">The out variable for where the particle can move without collision on the Y axis.</param>
 /// <returns>True if the particle is able to move at all.</returns>
-/// <remarks>DDA alogirthm: https://en.wikipedia.org/wiki/Digital_differential_analyzer_(graphics_algorithm) </remarks>
+/// <remarks>Straight lines, which is every probe particles make, find their first obstacle from the occupancy masks in a lookup or two.
+/// Anything else walks the line cell by cell using Bresenham's algorithm: https://en.wikipedia.org/wiki/Bresenham%27s_line_algorithm </remarks>
 bool ParticleSimulation::LineTest(int aiRequesterID, int aiStartX, int aiStartY, int aiEndX, int aiEndY, int& aiHitPointX, int& aiHitPointY)
 {
-	bool bRetVal = true;
-
-	float fDeltaX = (aiEndX - aiStartX);
-	float fDeltaY = (aiEndY - aiStartY);
-
-	const float fStep = abs(fDeltaX) >= abs(fDeltaY) ? abs(fDeltaX) : abs(fDeltaY);
+	const int iDeltaX = abs(aiEndX - aiStartX);
+	const int iDeltaY = abs(aiEndY - aiStartY);
+	const int iStepX = aiStartX < aiEndX ? 1 : -1;
+	const int iStepY = aiStartY < aiEndY ? 1 : -1;
 
-	fDeltaX /= fStep;
-	fDeltaY /= fStep;
-
-	float fX = aiStartX;
-	float fY = aiStartY;
-	int i = 0;
-	for (int i = 0; i <= fStep; ++i)
+	if ((iDeltaX == 0) != (iDeltaY == 0))
 	{
-		int x = fX;
-		int y = fY;
-		if (!IsPointWithinSimulation(x, y) || (particleIDMap[x][y] != aiRequesterID && GetParticleFromMap(particleIDMap[x][y])))
+		const int iLength = iDeltaX + iDeltaY;
+		const int iDirectionX = iDeltaX != 0 ? iStepX : 0;
+		const int iDirectionY = iDeltaY != 0 ? iStepY : 0;
+		const int iFreeCells = QFreeCellCount(aiStartX, aiStartY, iDirectionX, iDirectionY, iLength);
+		aiHitPointX = aiStartX + (iDirectionX * iFreeCells);
+		aiHitPointY = aiStartY + (iDirectionY * iFreeCells);
+
+		if (iFreeCells < iLength)
 		{
-			if (IsParticleDisplacementAllowed(aiRequesterID, particleIDMap[x][y]))
+			// The obstacle is either a particle, or a wall in the border or a non-resident chunk. Walls never refer to a particle, so are never displaced.
+			const int iObstacleX = aiHitPointX + iDirectionX;
+			const int iObstacleY = aiHitPointY + iDirectionY;
+			Particle* pCell = GetParticleFromMap(particleIDMap(iObstacleX, iObstacleY));
+			Particle* pRequester = pCell ? GetParticleFromMap(aiRequesterID) : nullptr;
+			if (pRequester && materialRegistry.QCanDisplace(static_cast<PARTICLE_TYPE>(pRequester->QType()), static_cast<PARTICLE_TYPE>(pCell->QType())))
 			{
-				aiHitPointX = x;
-				aiHitPointY = y;
+				aiHitPointX = iObstacleX;
+				aiHitPointY = iObstacleY;
 			}
-			break;
 		}
-
-		aiHitPointX = x;
-		aiHitPointY = y;
-		fX += fDeltaX;
-		fY += fDeltaY;
 	}
+	else
+	{
+		Particle* pRequester = GetParticleFromMap(aiRequesterID);
+		const PARTICLE_TYPE eRequesterType = pRequester ? static_cast<PARTICLE_TYPE>(pRequester->QType()) : PARTICLE_TYPE::NONE;
 
-	bRetVal = aiStartX != aiHitPointX && aiStartY != aiHitPointY;
+		int x = aiStartX;
+		int y = aiStartY;
+		int iError = iDeltaX - iDeltaY;
+		while (true)
+		{
+			// Each step moves at most a cell along either axis, so the line stops at the first cell of the border it reaches
+			const int iCellID = particleIDMap(x, y);
+			Particle* pCell = iCellID != aiRequesterID ? GetParticleFromMap(iCellID) : nullptr;
+			if (iCellID == WALL_PARTICLE_ID || pCell)
+			{
+				if (pCell && materialRegistry.QCanDisplace(eRequesterType, static_cast<PARTICLE_TYPE>(pCell->QType())))
+				{
+					aiHitPointX = x;
+					aiHitPointY = y;
+				}
+				break;
+			}
 
-	return bRetVal;
+			aiHitPointX = x;
+			aiHitPointY = y;
+			if (x == aiEndX && y == aiEndY)
+			{
+				break;
+			}
+
+			const int iError2 = iError * 2;
+			if (iError2 > -iDeltaY)
+			{
+				iError -= iDeltaY;
+				x += iStepX;
+			}
+			if (iError2 < iDeltaX)
+			{
+				iError += iDeltaX;
+				y += iStepY;
+			}
+		}
+	}
+
+	return aiStartX != aiHitPointX && aiStartY != aiHitPointY;
 }
 
 /// <summary>
 /// Caches the current state of each particle in particleMap as a ParticleSnapshot, returning them in a SimulationSnapshot
 /// </summary>
+/// <remarks>While streaming, chunks that have been paged out are read back from the chunk store as well, waiting on the disk.</remarks>
 SimulationSnapshot ParticleSimulation::CreateSimulationSnapshot()
 {
 	SimulationSnapshot retVal = SimulationSnapshot();
 
 
-#ifdef USE_THREADED_CHUNKS
-	ChunkTickLock.lock();
-	ParticleMapLock.lock();
-#endif
-	for (std::pair<int, std::shared_ptr<Particle>> mapping : particleMap)
+	for (PooledParticlePtr& pParticle : particleMap)
 	{
-		if (mapping.second)
+		if (pParticle)
 		{
 			ParticleSnapshot snap = ParticleSnapshot();
-			snap.tType = static_cast<PARTICLE_TYPE>(mapping.second->QType());
-			snap.iTemp = mapping.second->QTemperature();
-			snap.x = mapping.second->QX();
-			snap.y = mapping.second->QY();
+			snap.tType = static_cast<PARTICLE_TYPE>(pParticle->QType());
+			snap.iTemp = pParticle->QTemperature();
+			snap.x = pParticle->QX();
+			snap.y = pParticle->QY();
 			retVal.cachedParticles.push_back(snap);
 		}
 	}
-#ifdef USE_THREADED_CHUNKS
-	ParticleMapLock.unlock();
-	ChunkTickLock.unlock();
-#endif
 
+	// While streaming, chunks that aren't resident only exist in the chunk store, so are read back from it. Chunks still paging in keep their file until spawned.
+	if (bStreaming)
+	{
+		for (int i = 0; i < iChunkCount; ++i)
+		{
+			if (chunkResidency[i] == CHUNK_RESIDENCY::PAGED_OUT || chunkResidency[i] == CHUNK_RESIDENCY::PAGING_IN)
+			{
+				const StoredChunk chunk = chunkStore->LoadNow(i);
+				retVal.cachedParticles.insert(retVal.cachedParticles.end(), chunk.particles.begin(), chunk.particles.end());
+			}
+		}
+	}
+	retVal.iWidth = iWidth;
+	retVal.iHeight = iHeight;
 	std::cout << "Snapshot taken!\n";
 	return retVal;
 }
@@ -665,43 +1445,54 @@ SimulationSnapshot ParticleSimulation::CreateSimulationSnapshot()
 /// </summary>
 void ParticleSimulation::ResetSimulation()
 {
-	for (std::pair<int, std::shared_ptr<Particle>> mapping : particleMap)
+	for (PooledParticlePtr& pParticle : particleMap)
 	{
-		if (mapping.second)
+		if (pParticle)
 		{
-			mapping.second->ForceExpire();
+			pParticle->ForceExpire();
 		}
 	}
+	WakeAllChunks();
 	bForceFullUpdate = true;
+
+	// Forget any chunks paged out while streaming, so they're never paged back in
+	if (bStreaming)
+	{
+		for (int i = 0; i < iChunkCount; ++i)
+		{
+			if (chunkResidency[i] != CHUNK_RESIDENCY::RESIDENT)
+			{
+				SetChunkResidency(i, CHUNK_RESIDENCY::UNLOADED);
+			}
+		}
+	}
 }
 
 /// <summary>
 /// Forceably deletes all current particles and spawns new ones based on a snapshot
 /// </summary>
-/// <remarks>Acquires ParticleMapLock to ensure security when resetting the particle map.</remarks>
 void ParticleSimulation::ResetSimulation(SimulationSnapshot asSnapshot)
 {
-#ifdef USE_THREADED_CHUNKS
-	ParticleMapLock.lock();
-#endif
-	// First, release all smart pointers in the existing particle map
-	for (std::pair<int, std::shared_ptr<Particle>> mapping : particleMap)
+	// Streaming restarts once the snapshot is applied, so chunks paged out from the old simulation are discarded
+	const bool bWasStreaming = bStreaming;
+	EndStreaming();
+
+	// First, release all existing particles, invalidating their handles
+	// Snapshots taken at a different size resize the simulation, which clears it as well
+	if (asSnapshot.iWidth > 0 && asSnapshot.iHeight > 0 && (asSnapshot.iWidth != iWidth || asSnapshot.iHeight != iHeight))
 	{
-		if (mapping.second)
-		{
-			mapping.second.reset();
-		}
+		ResizeSimulation(asSnapshot.iWidth, asSnapshot.iHeight, particleIDMap.QSparse());
 	}
-	particleMap.clear();
-	for (int x = 0; x < simulationResolution; ++x)
+	else
 	{
-
-		for (int y = 0; y < simulationResolution; ++y)
-		{
-			particleIDMap[x][y] = NULL_PARTICLE_ID;
-			particleHeatMap[x][y] = 0;
-			updatedParticleIDs[x][y] = NULL_PARTICLE_ID;
-		}
+		// Wake every chunk before clearing it, so the whole canvas is redrawn
+		WakeAllChunks();
+
+		particleMap.Clear();
+		iActiveParticles = 0;
+		particleIDMap.Fill(NULL_PARTICLE_ID);
+		particleHeatMap.Fill(0);
+		ClearCellOccupancy();
 	}
 
 	// Then create new particles from the particle snapshots
@@ -710,85 +1501,157 @@ void ParticleSimulation::ResetSimulation(SimulationSnapshot asSnapshot)
 		SpawnParticle(snap.x, snap.y, snap.tType);
 	}
 
+	if (bWasStreaming)
+	{
+		EnableStreaming(sStreamingStoreDirectory, iStreamingRadius);
+	}
+
 	std::cout << "Snapshot applied!\n";
-#ifdef USE_THREADED_CHUNKS
-	ParticleMapLock.unlock();
-#endif
 }
 
 /// <summary>
-/// Helper function to check the number of particles that are currently at full processing.
+/// Reallocates the simulation at a new size, deleting every particle
 /// </summary>
-/// <remarks>Itterates over the entire particleMap hashmap. Best to use just as a debugging function. Note: This may be stripped out of release builds at a later date.</remarks>
-int ParticleSimulation::QActiveParticleCount()
+/// <param name="aiWidth">Width of the simulation, in cells</param>
+/// <param name="aiHeight">Height of the simulation, in cells</param>
+/// <param name="abSparse">When true, each chunk's storage is only allocated once a particle is spawned or moves into it, and freed once it has been empty for a while</param>
+/// <remarks>Dimensions are rounded up to a whole number of chunks. Sizes over maxSimulationCellCount, or maxSparseSimulationCellCount for sparse worlds, are rejected, leaving the simulation as it was.
+/// Any canvas passed to Tick must be recreated at the new size. Ends streaming.</remarks>
+void ParticleSimulation::ResizeSimulation(int aiWidth, int aiHeight, bool abSparse)
 {
-	int iRestingParticleCount = 0;
-	for (std::pair<int, std::shared_ptr<Particle>> mapping : particleMap)
+	const int iNewChunkCountX = std::max(1, (aiWidth + chunkSize - 1) / chunkSize);
+	const int iNewChunkCountY = std::max(1, (aiHeight + chunkSize - 1) / chunkSize);
+	if (static_cast<long long>(iNewChunkCountX) * iNewChunkCountY * chunkSize * chunkSize > (abSparse ? maxSparseSimulationCellCount : maxSimulationCellCount))
 	{
-		if (mapping.second)
-		{
-			if (mapping.second->QResting())
-			{
-				++iRestingParticleCount;
-			}
-		}
+		std::cout << "Simulation size " << aiWidth << "x" << aiHeight << " is out of range!\n";
+		return;
+	}
+
+	EndStreaming();
+	particleMap.Clear();
+	iActiveParticles = 0;
+
+	iChunkCountX = iNewChunkCountX;
+	iChunkCountY = iNewChunkCountY;
+	iChunkCount = iChunkCountX * iChunkCountY;
+	iWidth = iChunkCountX * chunkSize;
+	iHeight = iChunkCountY * chunkSize;
+
+	if (abSparse)
+	{
+		particleIDMap.ResizeSparse(iWidth, iHeight, chunkSize, NULL_PARTICLE_ID, simulationBorder, WALL_PARTICLE_ID);
+		particleHeatMap.ResizeSparse(iWidth, iHeight, chunkSize, 0);
+	}
+	else
+	{
+		particleIDMap.Resize(iWidth, iHeight, NULL_PARTICLE_ID, eGridLayout, iGridTileSize, simulationBorder, WALL_PARTICLE_ID);
+		particleHeatMap.Resize(iWidth, iHeight, 0, eGridLayout, iGridTileSize);
+	}
+
+	columnOccupancy.reset(new std::atomic<uint32_t>[static_cast<size_t>(iChunkCountY) * iWidth]);
+	rowOccupancy.reset(new std::atomic<uint32_t>[static_cast<size_t>(iChunkCountX) * iHeight]);
+	ClearCellOccupancy();
+
+	bSleepingChunks.reset(new bool[iChunkCount]);
+	chunkLastAwakeTick.reset(new uint32_t[iChunkCount]);
+	chunkUpdateRects.reset(new ChunkRect[iChunkCount]);
+	chunkDirtyRects.reset(new ChunkDirtyRect[iChunkCount]);
+	chunkTickResults.reset(new ChunkTickResults[iChunkCount]);
+	queuedChunkIDs.reset(new int[iChunkCount]);
+	iQueuedChunkCount = 0;
+	iReleaseScanChunk = 0;
+
+	for (int i = 0; i < iChunkCount; ++i)
+	{
+		bSleepingChunks[i] = true;
+		chunkLastAwakeTick[i] = uiTickEpoch;
+		chunkUpdateRects[i] = { INT_MAX, INT_MAX, -1, -1 };
+		chunkDirtyRects[i].Reset();
 	}
-	return particleMap.size() - iRestingParticleCount;
+
+	// Wake every chunk, so the whole canvas is drawn on the first tick
+	WakeAllChunks();
 }
 
 /// <summary>
-/// Helper function to check if a point is within the bounds of the simulation.
+/// Changes the order particleIDMap and particleHeatMap store their cells in, reallocating them and deleting every particle
 /// </summary>
-bool ParticleSimulation::IsPointWithinSimulation(unsigned int aiX, unsigned int aiY)
+/// <param name="aeLayout">Order to store cells in</param>
+/// <param name="aiTileSize">Width and height of each tile, for the tiled layouts</param>
+/// <remarks>Only dense worlds use the layout. Sparse worlds always store cells in chunk sized blocks, but remember the layout for when they next become dense.</remarks>
+void ParticleSimulation::SetGridLayout(GRID_LAYOUT aeLayout, int aiTileSize)
+{
+	eGridLayout = aeLayout;
+	iGridTileSize = aiTileSize;
+	ResizeSimulation(iWidth, iHeight, QSparse());
+}
+
+/// <summary>
+/// Returns the number of particles constructed in the particle pools since the start of the last full tick
+/// </summary>
+int ParticleSimulation::QParticleAllocations()
 {
-	return aiX < simulationResolution&& aiY < simulationResolution&& aiX >= 0 && aiY >= 0;
+	return powderPool.QStats().iAllocations + liquidPool.QStats().iAllocations + gasPool.QStats().iAllocations + solidPool.QStats().iAllocations;
 }
 
 /// <summary>
-/// Helper function to determine any special cases where a particle can displace another/move into anothers space
+/// Returns the number of particle allocations since the start of the last full tick that reused memory from a pool's free list
 /// </summary>
-/// <param name="aiMovingParticleID">The ID for the moving particle.</param>
-/// <param name="aiTargetParticleID">The ID for the displaced particle.</param>
-bool ParticleSimulation::IsParticleDisplacementAllowed(int aiMovingParticleID, int aiTargetParticleID)
+int ParticleSimulation::QParticleRecycles()
 {
-	bool bAllowDisplacement = false;
-	
-	// Special case: Powders can displace liquids
-	bAllowDisplacement = dynamic_cast<ParticleLiquid*>(GetParticleFromMap(aiTargetParticleID).get()) && dynamic_cast<ParticlePowder*>(GetParticleFromMap(aiMovingParticleID).get());
+	return powderPool.QStats().iRecycles + liquidPool.QStats().iRecycles + gasPool.QStats().iRecycles + solidPool.QStats().iRecycles;
+}
 
-	return bAllowDisplacement;
+/// <summary>
+/// Returns the number of particles returned to the particle pools since the start of the last full tick
+/// </summary>
+int ParticleSimulation::QParticleFrees()
+{
+	return powderPool.QStats().iFrees + liquidPool.QStats().iFrees + gasPool.QStats().iFrees + solidPool.QStats().iFrees;
 }
 
 /// <summary>
-/// Helper function to access a partcile from particleMap
+/// Returns the number of arena blocks the particle pools requested from the heap since the start of the last full tick
 /// </summary>
-/// <param name="aiID">The ID of the particle you wish toa ccess in the unordered_map</param>
-/// <returns>shared_ptr associated with the passed ID. Nullptr if no mapping exists with said ID.</returns>
-std::shared_ptr<Particle> ParticleSimulation::GetParticleFromMap(int aiID)
+int ParticleSimulation::QPoolBlockAllocations()
 {
-	if (particleMap.find(aiID) != particleMap.end())
-	{
-		return particleMap.at(aiID);
-	}
-	return nullptr;
+	return powderPool.QStats().iBlockAllocations + liquidPool.QStats().iBlockAllocations + gasPool.QStats().iBlockAllocations + solidPool.QStats().iBlockAllocations;
 }
 
 /// <summary>
-/// Helper function to find the chunk a given position belongs to
+/// Sets the number of threads chunks are ticked on, counting the thread that calls Tick.
+/// Has no effect unless USE_THREADED_CHUNKS is defined.
 /// </summary>
-inline int ParticleSimulation::GetChunkForPosition(const int aiX)
+void ParticleSimulation::SetThreadCount(int aiThreadCount)
 {
-	int iParticleChunkID = 0;
-	for (int i = chunkStep; i < simulationResolution; i += chunkStep)
-	{
-		if (aiX >= i)
-		{
-			++iParticleChunkID;
-			continue;
-		}
-		break;
-	}
-	return iParticleChunkID;
+#ifdef USE_THREADED_CHUNKS
+	chunkWorkerPool = std::make_unique<WorkerThreadPool>(aiThreadCount > 1 ? aiThreadCount - 1 : 0);
+#else
+	(void)aiThreadCount;
+#endif
+}
+
+/// <summary>
+/// Returns the number of threads chunks are ticked on, counting the thread that calls Tick
+/// </summary>
+int ParticleSimulation::QThreadCount()
+{
+#ifdef USE_THREADED_CHUNKS
+	return chunkWorkerPool->QThreadCount();
+#else
+	return 1;
+#endif
+}
+
+/// <summary>
+/// Helper function to check if a point is within the bounds of the simulation.
+/// While streaming, points in chunks that aren't resident are outside the simulation.
+/// </summary>
+/// <remarks>Only needed where positions arrive from outside the simulation, such as the mouse. Particles probe the wall border around particleIDMap instead.</remarks>
+bool ParticleSimulation::IsPointWithinSimulation(unsigned int aiX, unsigned int aiY)
+{
+	return aiX < static_cast<unsigned int>(iWidth) && aiY < static_cast<unsigned int>(iHeight)
+		&& (!chunkResidency || chunkResidency[GetChunkForPosition(aiX, aiY)] == CHUNK_RESIDENCY::RESIDENT);
 }
 
 /// <summary>
@@ -818,29 +1681,10 @@ sf::Color ParticleSimulation::GetParticleColor(PARTICLE_TYPE aeParticleType, uns
 	}
 	else
 	{
-		// If not, pull from the pre-defined colours
-		switch (aeParticleType)
-		{
-		case PARTICLE_TYPE::SAND:
-			return COLOR_SAND;
-		case PARTICLE_TYPE::COAL:
-			return COLOR_COAL;
-		case PARTICLE_TYPE::LEAVES:
-			return COLOR_LEAVES;
-		case PARTICLE_TYPE::WOOD:
-			return COLOR_WOOD;
-		case PARTICLE_TYPE::METAL:
-			return COLOR_METAL;
-		case PARTICLE_TYPE::ROCK:
-			return COLOR_ROCK;
-		case PARTICLE_TYPE::STEAM:
-			return COLOR_STEAM;
-		case PARTICLE_TYPE::SMOKE:
-			return COLOR_SMOKE;
-		case PARTICLE_TYPE::WATER:
-			return COLOR_WATER;
-		case PARTICLE_TYPE::LAVA:
-			return COLOR_LAVA;
+		// If not, pull from the material's colour
+		if (materialRegistry.QRegistered(aeParticleType))
+		{
+			return sf::Color(materialRegistry.QColor(aeParticleType));
 		}
 	}
 	return sf::Color(255,255,255, 0);	// Transparent
@@ -849,14 +1693,17 @@ sf::Color ParticleSimulation::GetParticleColor(PARTICLE_TYPE aeParticleType, uns
 /// <summary>
 /// Helper function to detect a particle on the edge of a shape
 /// </summary>
-bool ParticleSimulation::IsParticleOnEdge(unsigned int aiX, unsigned int aiY)
+bool ParticleSimulation::IsParticleOnEdge(int aiX, int aiY)
 {
 	bool bRetVal = false;
 
 	auto NeighborCheckFunctor = [&bRetVal, this](int aiTargetX, int aiTargetY)
 	{
 		if (!bRetVal)
-			bRetVal = IsPointWithinSimulation(aiTargetX, aiTargetY) && !IsSpaceOccupied(aiTargetX, aiTargetY);
+		{
+			const int iNeighborID = particleIDMap(aiTargetX, aiTargetY);
+			bRetVal = iNeighborID != WALL_PARTICLE_ID && !GetParticleFromMap(iNeighborID);
+		}
 	};
 
 	NeighborCheckFunctor(aiX + 1,	aiY);
@@ -1,17 +1,68 @@
 #pragma once
 
+#include <atomic>
+#include <ctime>
 #include <memory>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
 #include "Particle.h"
+#include "ParticleGas.h"
+#include "ParticleLiquid.h"
+#include "ParticlePool.h"
+#include "ParticlePowder.h"
+#include "ParticleSlotMap.h"
+#include "ParticleSolid.h"
+#include "SimulationGrid.h"
 
 #define NULL_PARTICLE_ID 0
+#define WALL_PARTICLE_ID static_cast<int>(slotIndexMask)		// Fills the border around particleIDMap and any non-resident chunks. Has a generation of 0, so never refers to a particle.
 
-constexpr int simulationResolution = 256;
-constexpr int chunkCount = 8;
-constexpr int chunkStep = simulationResolution / chunkCount;
+constexpr int defaultSimulationWidth = 256;
+constexpr int defaultSimulationHeight = 256;
+constexpr int maxSimulationCellCount = 1 << slotIndexBits;						// Every cell can hold a particle, so the world can't have more cells than the slot map has slots
+constexpr int maxSparseSimulationCellCount = 1 << 28;							// Sparse worlds only store occupied chunks, so can be larger. Particles are still capped at maxSimulationCellCount.
+constexpr int chunkSize = 32;													// Width and height of a chunk, in cells
 
+static_assert((chunkSize & (chunkSize - 1)) == 0, "Chunks must be a power of two wide, as sparse worlds store each chunk as a grid block");
+static_assert(chunkSize <= 32, "Each column of a chunk keeps its occupancy in a 32-bit mask");
+
+// Cells whose support or flow can change when a cell is vacated: above and diagonally above for falling powders,
+// either side for powders sliding diagonally and liquids flowing up to their horizontal velocity, and below for rising gases
+constexpr int wakeNeighborCount = 8;
+constexpr int wakeNeighborOffsets[wakeNeighborCount][2] =
+{
+	{ 0, -1 }, { -1, -1 }, { 1, -1 },
+	{ -1, 0 }, { 1, 0 }, { -2, 0 }, { 2, 0 },
+	{ 0, 1 }
+};
+
+/// <summary>
+/// Furthest a wakeNeighborOffsets entry is from the vacated cell along either axis
+/// </summary>
+constexpr int QWakeNeighborReach()
+{
+	int iReach = 0;
+	for (int i = 0; i < wakeNeighborCount; ++i)
+	{
+		for (int iAxis = 0; iAxis < 2; ++iAxis)
+		{
+			const int iOffset = wakeNeighborOffsets[i][iAxis] < 0 ? -wakeNeighborOffsets[i][iAxis] : wakeNeighborOffsets[i][iAxis];
+			iReach = iOffset > iReach ? iOffset : iReach;
+		}
+	}
+	return iReach;
+}
+
+// Width of the wall border around particleIDMap. Particles only probe their direct neighbours, line tests stop at the first wall they reach, and waking reaches furthest.
+constexpr int simulationBorder = 2;
+static_assert(simulationBorder <= chunkSize, "Sparse worlds build the border from chunk sized blocks");
+
+constexpr int defaultStreamingRadius = 8;										// Chunks either side of the focus kept resident in a streaming world
+
+constexpr float fFixedTickRate = 60.0f;											// Number of ticks per second
+constexpr float fFixedTickInterval = (1.0f / fFixedTickRate) * CLOCKS_PER_SEC;	// Time between ticks
 
 enum class PARTICLE_TYPE : uint8_t
 {
@@ -33,10 +84,22 @@ enum class PARTICLE_TYPE : uint8_t
 	COUNT
 };
 
+struct ChunkRect;
+struct ChunkDirtyRect;
+struct ChunkTickResults;
+struct StoredChunk;
+enum class CHUNK_RESIDENCY : uint8_t;
+class ChunkStore;
+class WorkerThreadPool;
+
+// Chunks are split into a 2x2 checkerboard of phases when ticked on worker threads. Chunks in the same phase are never adjacent, so need no locking.
+// ParticleMaterials.h asserts chunks are at least twice a particle's reach wide for this to hold.
+constexpr int chunkPhaseCount = 4;
+
 class DebugToggles
 {
 public:
-	static DebugToggles& const QInstance()
+	static DebugToggles& QInstance()
 	{
 		static DebugToggles instance;
 		return instance;
@@ -55,25 +118,25 @@ struct ParticleSnapshot
 
 struct SimulationSnapshot
 {
+	int iWidth = 0;		// Dimensions of the simulation the snapshot was taken from. 0 if unknown, in which case the current dimensions are kept.
+	int iHeight = 0;
 	std::vector<ParticleSnapshot> cachedParticles;
 };
 
 class ParticleSimulation
 {
+	friend class SimulationPrimitiveBenchmarks;
+
 public:
 
-	static ParticleSimulation& const QInstance()
+	static ParticleSimulation& QInstance()
 	{
 		static ParticleSimulation instance;
 		return instance;
 	};
 
-	ParticleSimulation()
-	{
-		Initialize();
-		cClock = clock();
-	}
-
+	ParticleSimulation(int aiWidth = defaultSimulationWidth, int aiHeight = defaultSimulationHeight, bool abSparse = false);
+	~ParticleSimulation();
 
 	bool Tick(sf::Image& arCanvas);
 
@@ -87,56 +150,156 @@ public:
 
 	bool LineTest(int aiRequesterID, int aiStartX, int aiStartY, int aiEndX, int aiEndY, int& aiHitPointX, int& aiHitPointY);
 
+	sf::Color GetParticleColor(PARTICLE_TYPE aeParticleType, unsigned int aiX, unsigned int aiY, bool abUseTexture = true);
+
 	SimulationSnapshot CreateSimulationSnapshot();
 	void ResetSimulation();
 	void ResetSimulation(SimulationSnapshot asSnapshot);
+	void ResizeSimulation(int aiWidth, int aiHeight, bool abSparse = false);
+
+	void SetTickPacing(bool abPaceTicks) { bPaceTicks = abPaceTicks; }
+	void SetThreadCount(int aiThreadCount);
+	void SetGridLayout(GRID_LAYOUT aeLayout, int aiTileSize = defaultGridTileSize);
+	void SetClassBatching(bool abClassBatching) { bClassBatching = abClassBatching; }
+
+	void EnableStreaming(const std::string& asStoreDirectory, int aiResidentRadius = defaultStreamingRadius);
+	void SetStreamingFocus(int aiX, int aiY);
 
-	int QParticleCount()		{ return particleMap.size(); };
-	int QActiveParticleCount();
+	int QWidth()				{ return iWidth; }
+	int QHeight()				{ return iHeight; }
+	int QChunkCountX()			{ return iChunkCountX; }
+	int QChunkCountY()			{ return iChunkCountY; }
+	int QChunkCount()			{ return iChunkCount; }
+	bool QSparse()				{ return particleIDMap.QSparse(); }
+	GRID_LAYOUT QGridLayout()	{ return eGridLayout; }
+	bool QClassBatching()		{ return bClassBatching; }
+	int QAllocatedChunkCount()	{ return particleIDMap.QSparse() ? particleIDMap.QAllocatedBlockCount() : iChunkCount; }
+	bool QStreaming()			{ return bStreaming; }
+	int QResidentChunkCount();
+	int QParticleCount()		{ return particleMap.Size(); };
+	int QActiveParticleCount()	{ return iActiveParticles; }
 	int QParticleVisitsTotal() { return iPixelsVisitted_Total; }
-	int QParticleVisitsPreChunk() { return iPixelsVisitted_PreChunk; }
-	int QParticleVisitsAllowUpdate() { return iPixelsVisitted_AllowUpdate; }
+	int QParticleVisitsRedraw() { return iPixelsVisitted_Redraw; }
 	int QParticleVisitsExpiredCleanup() { return iPixelsVisitted_ExpiredCleanup; }
 	int QParticleVisitsChunkTick() { return iPixelsVisitted_ChunkTick; }
 	int QParticleVisitsWakeChunk() { return iPixelsVisitted_WakeChunk; }
 	int QChunkVisits() { return iChunksVisitted; }
 	int QBurningParticles() { return iBurningParticles; }
+	int QClassTickMicroseconds(PARTICLE_CLASS aeClass) { return classTickMicroseconds[static_cast<int>(aeClass)]; }
+	int QParticleAllocations();
+	int QParticleRecycles();
+	int QParticleFrees();
+	int QPoolBlockAllocations();
+	int QThreadCount();
 
 protected:
 	void Initialize();
-	void TickChunk(std::unordered_map<int, std::shared_ptr<Particle>>* amParticleMap, sf::Image* arCanvas, std::vector<int>* arExpiredIDs);
+	template <typename T>
+	void TickParticle(T* apParticle, sf::Image& arCanvas, ChunkTickResults& arResults);
+	void UpdateOrBatchParticle(Particle* apParticle, sf::Image& arCanvas, ChunkTickResults& arResults);
+	template <PARTICLE_CLASS eClass>
+	void TickClassBatch(sf::Image& arCanvas, ChunkTickResults& arResults);
+	void TickClassBatches(sf::Image& arCanvas, ChunkTickResults& arResults);
+	void TickChunk(int aiChunkID, sf::Image* arCanvas);
+	void DrawChunk(int aiChunkID, sf::Image& arCanvas);
+	void WakeChunk(int aiChunkID);
+	void WakeAllChunks();
+	void ReleaseEmptyChunks();
+	void UpdateStreaming();
+	void PageOutChunk(int aiChunkID);
+	void SetChunkResidency(int aiChunkID, CHUNK_RESIDENCY aeResidency);
+	void RequestChunkPageIn(int aiChunkID);
+	void EndStreaming();
+	bool IsChunkWithinStreamingRadius(int aiChunkID);
+	int WakeNeighboringParticles(int aiX, int aiY);
+	void MarkCellDirty(int aiX, int aiY);
+	void UpdateCellOccupancy(int aiX, int aiY);
+	void FlipCellOccupancy(int aiX, int aiY, int aiNewX, int aiNewY);
+	void ClearCellOccupancy();
+	int QFreeCellCount(int aiX, int aiY, int aiStepX, int aiStepY, int aiLength);
+	void RefreshActiveState(Particle* apParticle);
 
-	bool IsParticleOnEdge(unsigned int aiX, unsigned int aiY);
+	bool IsParticleOnEdge(int aiX, int aiY);
 	bool IsPointWithinSimulation(unsigned int aiX, unsigned int aiY);
-	bool IsParticleDisplacementAllowed(int aiMovingParticle, int aiTargetParticle);
-	std::shared_ptr<Particle> GetParticleFromMap(int aiID);
+	int GetChunkForPosition(int aiX, int aiY) { return ((aiY / chunkSize) * iChunkCountX) + (aiX / chunkSize); }
+	Particle* GetParticleFromMap(int aiID) { return particleMap.Get(aiID); }
 
-	inline int GetChunkForPosition(const int aiX);
+private:
+	SimulationGrid<int> particleIDMap;
+	SimulationGrid<int> particleHeatMap;
+	GRID_LAYOUT eGridLayout = GRID_LAYOUT::COLUMNS;		// Layout of the dense grids. Sparse grids are always stored in chunk sized blocks.
+	int iGridTileSize = defaultGridTileSize;
+	bool bClassBatching = false;		// When true, each chunk's particles are gathered by class, then each class is updated as a batch
 
-	sf::Color GetParticleColor(PARTICLE_TYPE aeParticleType, unsigned int aiX, unsigned int aiY, bool abUseTexture = true);
+	int iWidth = 0;
+	int iHeight = 0;
+	int iChunkCountX = 0;
+	int iChunkCountY = 0;
+	int iChunkCount = 0;
 
-private:
-	int particleIDMap[simulationResolution][simulationResolution];
-	int updatedParticleIDs[simulationResolution][simulationResolution];
-	int particleHeatMap[simulationResolution][simulationResolution];
+	// Pools must outlive particleMap, as destroying the map returns every particle to its pool
+	ParticlePool<ParticlePowder> powderPool;
+	ParticlePool<ParticleLiquid> liquidPool;
+	ParticlePool<ParticleGas> gasPool;
+	ParticlePool<ParticleSolid> solidPool;
 
-	std::unordered_map<int, std::shared_ptr<Particle>> particleMap;
+	ParticleSlotMap particleMap;
 
 	std::vector<int> forceWokenParticles;
 
-	int iUniqueParticleID = 1; 
-
 	int iPixelsVisitted_Total = 0;
-	int iPixelsVisitted_PreChunk = 0;
+	int iPixelsVisitted_Redraw = 0;
 	int iPixelsVisitted_WakeChunk = 0;
-	int iPixelsVisitted_AllowUpdate = 0;
 	int iPixelsVisitted_ExpiredCleanup = 0;
 	int iPixelsVisitted_ChunkTick = 0;
 
 	clock_t cClock;
 	bool bForceFullUpdate = false;
+	bool bPaceTicks = true;		// When false, every call to Tick runs a full tick rather than waiting for fFixedTickInterval
 
+	uint32_t uiTickEpoch = 1;	// Incremented every full tick. Particles stamped with the current epoch have already been updated this tick.
+	std::atomic<int> iActiveParticles{ 0 };	// Kept up to date as particles rest, wake, spawn and expire
 	int iChunksVisitted = 0;
 	int iBurningParticles = 0;
+	int classTickMicroseconds[static_cast<int>(PARTICLE_CLASS::COUNT)] = {};		// Time spent updating each class last tick, summed over every thread. Only measured when batching by class.
+	int iReleaseScanChunk = 0;	// Next chunk ReleaseEmptyChunks will check, in sparse worlds
+
+	bool bStreaming = false;	// When true, only chunks within iStreamingRadius of the focus chunk are resident. The rest are paged out to disk.
+	std::string sStreamingStoreDirectory;
+	int iStreamingRadius = 0;
+	int iFocusChunkX = 0;
+	int iFocusChunkY = 0;
+
+	std::unordered_map<PARTICLE_TYPE, sf::Image*> particleTextureAtlas;
+
+	// Chunk tables are sized by ResizeSimulation
+	std::unique_ptr<bool[]> bSleepingChunks;				// A chunk is sleeping when nothing inside it changed last tick, and is skipped entirely
+	std::unique_ptr<uint32_t[]> chunkLastAwakeTick;			// Tick epoch each chunk was last awake on, used to find idle chunks to release in sparse worlds
+	std::unique_ptr<ChunkRect[]> chunkUpdateRects;			// Cells to process this tick
+	std::unique_ptr<ChunkDirtyRect[]> chunkDirtyRects;		// Cells to process next tick
+	std::unique_ptr<ChunkTickResults[]> chunkTickResults;
+
+	// Chunks marked dirty since the start of the tick, which will be awake next tick. Only these chunks are visited, so the cost of a tick follows the active area, not the world size.
+	std::unique_ptr<int[]> queuedChunkIDs;
+	std::atomic<int> iQueuedChunkCount{ 0 };
+	std::vector<int> awakeChunkIDs;		// Chunks awake this tick, in chunk order
+	std::vector<int> drawnChunkIDs;		// Chunks awake this tick, followed by any sleeping chunks marked dirty during it
+
+	// A bit per cell for every column of every row of chunks, indexed by ((y / chunkSize) * width) + x. Bit n is the nth cell down the chunk.
+	// Lets line tests find the next obstacle down a column without visiting each cell.
+	std::unique_ptr<std::atomic<uint32_t>[]> columnOccupancy;
+	// The same bits for every row of every column of chunks, indexed by ((x / chunkSize) * height) + y. Bit n is the nth cell across the chunk.
+	// Lets line tests find the next obstacle along a row.
+	std::unique_ptr<std::atomic<uint32_t>[]> rowOccupancy;
+
+	// Streaming state, only allocated while streaming. Non-resident chunks are sealed with walls in particleIDMap, so are treated as outside the simulation.
+	std::unique_ptr<CHUNK_RESIDENCY[]> chunkResidency;
+	std::unique_ptr<ChunkStore> chunkStore;
+	std::vector<int> pendingPageOuts;				// Chunks that have left the streaming radius, waiting to be paged out
+	std::vector<StoredChunk> pendingPageIns;		// Chunks read back from the chunk store, waiting to be spawned
+	int iResidentChunks = 0;
+
+	std::unique_ptr<WorkerThreadPool> chunkWorkerPool;		// Created on initialization when ticking on worker threads, sized to the hardware
+	std::vector<int> phaseChunkIDs[chunkPhaseCount];		// Awake chunks, split by phase
 };
 
@@ -0,0 +1,756 @@
+#include "ParticleSimulationCA.h"
+
+#include "ParticleColors.h"
+#include "ParticleMaterials.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <iostream>
+#include <utility>
+
+/// <summary>
+/// Sweeps the grid once, updating every particle that hasn't already been updated this tick, then redraws the canvas.
+/// </summary>
+/// <param name="arCanvas">Reference to the sf::Image to draw the simulation onto.</param>
+/// <returns>True if a full tick was run, and the canvas has been redrawn.</returns>
+bool ParticleSimulationCA::Tick(sf::Image& arCanvas)
+{
+	iPixelsVisitted_Total = 0;
+	iPixelsVisitted_Redraw = 0;
+	iPixelsVisitted_ChunkTick = 0;
+	iPixelsVisitted_WakeChunk = 0;
+	iBurningParticles = 0;
+
+	clock_t cDeltaClock = clock() - cClock;
+	if (bPaceTicks && cDeltaClock <= fFixedTickInterval)
+	{
+		return false;
+	}
+	cClock = clock();
+	iParticleAllocations = 0;
+	iParticleFrees = 0;
+
+	// Particles that move ahead of the sweep keep the new parity, so aren't updated twice
+	uiTickParity ^= CA_FLAG_PARITY;
+
+	// Columns are swept bottom to top. With the default column layout, this reads the grid linearly.
+	for (int x = 0; x < iWidth; ++x)
+	{
+		for (int y = iHeight - 1; y >= 0; --y)
+		{
+			CACell& rCell = cellMap(x, y);
+			if (IsCellEmpty(rCell) || (rCell.uiFlags & CA_FLAG_PARITY) == uiTickParity)
+			{
+				continue;
+			}
+			rCell.uiFlags = (rCell.uiFlags & ~(CA_FLAG_PARITY | CA_FLAG_MOVED)) | uiTickParity;
+
+			switch (materials[rCell.uiType].eClass)
+			{
+			case PARTICLE_CLASS::POWDER:
+				UpdatePowder(x, y);
+				break;
+			case PARTICLE_CLASS::LIQUID:
+				UpdateLiquid(x, y);
+				break;
+			case PARTICLE_CLASS::GAS:
+				UpdateGas(x, y);
+				break;
+			case PARTICLE_CLASS::SOLID:
+				UpdateSolid(x, y);
+				break;
+			default:
+				break;
+			}
+
+			++iPixelsVisitted_Total;
+			++iPixelsVisitted_ChunkTick;
+		}
+	}
+
+	DrawCells(arCanvas);
+
+	return true;
+}
+
+/// <summary>
+/// Powder rules - mirrors ParticleSimulationSoA::TickPowders
+/// </summary>
+void ParticleSimulationCA::UpdatePowder(int aiX, int aiY)
+{
+	int x = aiX;
+	int y = aiY;
+	const CAMaterial& rMaterial = materials[cellMap(x, y).uiType];
+
+	// Movement
+	if (IS_CA_ACTIVE(cellMap(x, y).uiFlags))
+	{
+		// First, attempt to move downwards
+		int iTargetX = x;
+		int iTargetY = y + rMaterial.iVelocityY;
+		LineTest(x, y, iTargetX, iTargetY, iTargetX, iTargetY);
+		bool bMoved = RequestCellMove(x, y, iTargetX, iTargetY);
+		if (!bMoved)
+		{
+			// If that failed, attempt to move diagonally one way, then the other
+			iTargetY = y + 1;
+			iTargetX += 1;
+			bMoved = !IsSpaceOccupied(iTargetX, y) && RequestCellMove(x, y, iTargetX, iTargetY);
+			if (!bMoved)
+			{
+				iTargetX = x - 1;
+				bMoved = !IsSpaceOccupied(iTargetX, y) && RequestCellMove(x, y, iTargetX, iTargetY);
+			}
+		}
+
+		CACell& rCell = cellMap(x, y);
+		if (bMoved)
+		{
+			rCell.uiFailedMoves = 0;
+		}
+		else if (++rCell.uiFailedMoves >= rMaterial.iAttemptsBeforeRest)
+		{
+			rCell.uiFlags |= CA_FLAG_RESTING;
+		}
+	}
+
+	// Fire
+	CACell& rCell = cellMap(x, y);
+	if (rCell.iTemperature >= rMaterial.iIgnitionTemperature && !(rCell.uiFlags & CA_FLAG_BURNING))
+	{
+		rCell.iTemperature = rMaterial.iIgnitionTemperature;
+		rCell.uiFlags |= CA_FLAG_BURNING;
+		ForceWake(rCell);
+	}
+	if (rCell.uiFlags & CA_FLAG_BURNING)
+	{
+		rCell.iTemperature = FIRE_TEMP;
+		rCell.iFuel -= rMaterial.iBurningFuelConsumption;
+
+		++iBurningParticles;
+		HeatNeighboringCells(x, y, rCell.iTemperature * 0.05f);
+
+		if (rCell.iFuel <= 0)
+		{
+			ExpireCell(x, y, static_cast<uint8_t>(PARTICLE_TYPE::NONE));
+		}
+	}
+}
+
+/// <summary>
+/// Liquid rules - mirrors ParticleSimulationSoA::TickLiquids
+/// </summary>
+void ParticleSimulationCA::UpdateLiquid(int aiX, int aiY)
+{
+	int x = aiX;
+	int y = aiY;
+	const CAMaterial& rMaterial = materials[cellMap(x, y).uiType];
+
+	// Movement
+	if (IS_CA_ACTIVE(cellMap(x, y).uiFlags))
+	{
+		// First, attempt to move downwards
+		int iTargetX = x;
+		int iTargetY = y + rMaterial.iVelocityY;
+		LineTest(x, y, iTargetX, iTargetY, iTargetX, iTargetY);
+		bool bMoved = RequestCellMove(x, y, iTargetX, iTargetY);
+		if (!bMoved)
+		{
+			// If that failed, attempt to move horizontally one way, then the other
+			LineTest(x, y, x + rMaterial.iVelocityX, y, iTargetX, iTargetY);
+			bMoved = RequestCellMove(x, y, iTargetX, iTargetY);
+			if (!bMoved)
+			{
+				LineTest(x, y, x - rMaterial.iVelocityX, y, iTargetX, iTargetY);
+				bMoved = RequestCellMove(x, y, iTargetX, iTargetY);
+			}
+		}
+
+		CACell& rCell = cellMap(x, y);
+		if (bMoved)
+		{
+			rCell.uiFailedMoves = 0;
+		}
+		else if (++rCell.uiFailedMoves >= rMaterial.iAttemptsBeforeRest)
+		{
+			rCell.uiFlags |= CA_FLAG_RESTING;
+		}
+	}
+
+	// Fire
+	if (rMaterial.bShouldExtinguish)
+	{
+		ExtinguishNeighboringCells(x, y);
+	}
+
+	// Cooling/freezing behavior
+	CACell& rCell = cellMap(x, y);
+	if (rMaterial.iCoolingRate > 0)
+	{
+		if (rCell.uiTicksSinceCool > rMaterial.iCoolingRate)
+		{
+			rCell.uiTicksSinceCool = 0;
+			--rCell.iTemperature;
+			if (rCell.iTemperature <= rMaterial.iFreezingTemperature)
+			{
+				ExpireCell(x, y, rMaterial.uiFrozenParticleType);
+				return;
+			}
+		}
+		++rCell.uiTicksSinceCool;
+	}
+
+	if (rCell.uiFlags & CA_FLAG_BURNING)
+	{
+		++iBurningParticles;
+		HeatNeighboringCells(x, y, rCell.iTemperature * 0.05f);
+	}
+}
+
+/// <summary>
+/// Gas rules - mirrors ParticleSimulationSoA::TickGases
+/// </summary>
+void ParticleSimulationCA::UpdateGas(int aiX, int aiY)
+{
+	int x = aiX;
+	int y = aiY;
+
+	// Movement - up, then either side
+	if (!(cellMap(x, y).uiFlags & CA_FLAG_RESTING))
+	{
+		if (!RequestCellMove(x, y, x, y - 1)
+			&& !RequestCellMove(x, y, x + 1, y)
+			&& !RequestCellMove(x, y, x - 1, y))
+		{
+			cellMap(x, y).uiFlags |= CA_FLAG_RESTING;
+		}
+	}
+
+	// Lifetime
+	CACell& rCell = cellMap(x, y);
+	--rCell.iFuel;
+	if (rCell.iFuel <= 0)
+	{
+		ExpireCell(x, y, static_cast<uint8_t>(PARTICLE_TYPE::NONE));
+	}
+}
+
+/// <summary>
+/// Solid rules - mirrors ParticleSimulationSoA::TickSolids
+/// </summary>
+void ParticleSimulationCA::UpdateSolid(int aiX, int aiY)
+{
+	CACell& rCell = cellMap(aiX, aiY);
+	const CAMaterial& rMaterial = materials[rCell.uiType];
+
+	// Solids never move, they only settle once they stop burning
+	if (!(rCell.uiFlags & CA_FLAG_BURNING))
+	{
+		rCell.uiFlags |= CA_FLAG_RESTING;
+	}
+
+	// Melting
+	if (!(rCell.uiFlags & CA_FLAG_BURNING) && rMaterial.iMeltingPoint > 0 && rCell.iTemperature >= rMaterial.iMeltingPoint && rCell.iTemperature < rMaterial.iIgnitionTemperature)
+	{
+		ExpireCell(aiX, aiY, rMaterial.uiDeathParticleType);
+		return;
+	}
+
+	// Ignition
+	if (rCell.iTemperature >= rMaterial.iIgnitionTemperature && !(rCell.uiFlags & CA_FLAG_BURNING))
+	{
+		rCell.iTemperature = FIRE_TEMP;
+		rCell.uiFlags |= CA_FLAG_BURNING;
+		rCell.uiFlags &= ~CA_FLAG_RESTING;
+	}
+
+	// Burning
+	if (rCell.uiFlags & CA_FLAG_BURNING)
+	{
+		rCell.iTemperature = FIRE_TEMP;
+		rCell.iFuel -= rMaterial.iBurningFuelConsumption;
+
+		++iBurningParticles;
+		HeatNeighboringCells(aiX, aiY, rCell.iTemperature * 0.05f);
+
+		if (rCell.iFuel <= 0)
+		{
+			ExpireCell(aiX, aiY, rMaterial.uiDeathParticleType);
+		}
+	}
+}
+
+/// <summary>
+/// Empties a cell whose particle has expired, waking its neighbors, and spawns a replacement particle in its place
+/// </summary>
+/// <param name="auiReplacementType">Type of particle to spawn in the cell, or NONE to leave it empty</param>
+/// <remarks>The replacement isn't updated until the next tick.</remarks>
+void ParticleSimulationCA::ExpireCell(int aiX, int aiY, uint8_t auiReplacementType)
+{
+	cellMap(aiX, aiY) = CACell();
+	--iParticleCount;
+	++iParticleFrees;
+
+	// Wake any resting particles that could move into the space this particle left
+	WakeNeighboringCells(aiX, aiY);
+
+	if (auiReplacementType != static_cast<uint8_t>(PARTICLE_TYPE::NONE))
+	{
+		SpawnParticle(aiX, aiY, static_cast<PARTICLE_TYPE>(auiReplacementType));
+	}
+}
+
+/// <summary>
+/// Redraws every occupied cell onto a clear canvas, counting the active particles along the way
+/// </summary>
+void ParticleSimulationCA::DrawCells(sf::Image& arCanvas)
+{
+	arCanvas.create(iWidth, iHeight, COLOR_CLEAR);
+	iActiveParticles = 0;
+
+	for (int x = 0; x < iWidth; ++x)
+	{
+		for (int y = 0; y < iHeight; ++y)
+		{
+			const CACell& rCell = cellMap(x, y);
+			if (IsCellEmpty(rCell))
+			{
+				continue;
+			}
+
+			const PARTICLE_TYPE eType = static_cast<PARTICLE_TYPE>(rCell.uiType);
+			sf::Color cCol = ((rCell.uiFlags & CA_FLAG_BURNING) && !IS_LIQUID_CHECK(eType))
+				? COLOR_FIRE
+				: ParticleSimulation::QInstance().GetParticleColor(eType, x, y, !(rCell.uiFlags & CA_FLAG_MOVED));
+			if (IsParticleOnEdge(x, y))
+			{
+				cCol.a = 170;
+			}
+			arCanvas.setPixel(x, y, cCol);
+
+			iActiveParticles += IS_CA_ACTIVE(rCell.uiFlags);
+			++iPixelsVisitted_Total;
+			++iPixelsVisitted_Redraw;
+		}
+	}
+}
+
+/// <summary>
+/// Copies the material registry into a single record per type, narrowing counters to fit the packed cells
+/// </summary>
+void ParticleSimulationCA::Initialize()
+{
+	for (const MaterialDefinition& rDefinition : materialDefinitions)
+	{
+		CAMaterial& rMaterial = materials[static_cast<int>(rDefinition.eType)];
+		rMaterial.eClass = rDefinition.eClass;
+		rMaterial.iAttemptsBeforeRest = rDefinition.iAttemptsBeforeRest;
+		rMaterial.iVelocityX = rDefinition.iVelocityX;
+		rMaterial.iVelocityY = rDefinition.iVelocityY;
+		rMaterial.iIgnitionTemperature = rDefinition.iIgnitionTemperature;
+		rMaterial.iBurningFuelConsumption = rDefinition.iBurningFuelConsumption;
+		rMaterial.iFuel = rDefinition.iFuel;
+		rMaterial.iMeltingPoint = rDefinition.iMeltingPoint;
+		rMaterial.iFreezingTemperature = rDefinition.iFreezingTemperature;
+		rMaterial.iCoolingRate = rDefinition.iCoolingRate;
+		rMaterial.uiDeathParticleType = static_cast<uint8_t>(rDefinition.eDeathType);
+		rMaterial.uiFrozenParticleType = static_cast<uint8_t>(rDefinition.eFrozenType);
+		rMaterial.bShouldExtinguish = rDefinition.bShouldExtinguish;
+		rMaterial.bHeatSurroundings = rDefinition.bHeatSurroundings;
+
+		// Counters are held in a byte, and fuel in 16 bits
+		rMaterial.iAttemptsBeforeRest = std::min(rMaterial.iAttemptsBeforeRest, UCHAR_MAX);
+		rMaterial.iCoolingRate = std::min(rMaterial.iCoolingRate, UCHAR_MAX - 1);
+		rMaterial.iFuel = std::min(rMaterial.iFuel, SHRT_MAX);
+	}
+}
+
+/// <summary>
+/// Returns a freshly spawned particle of a given type
+/// </summary>
+CACell ParticleSimulationCA::CreateCell(PARTICLE_TYPE aeParticleType)
+{
+	const CAMaterial& rMaterial = materials[static_cast<int>(aeParticleType)];
+
+	CACell cell = CACell();
+	cell.uiType = static_cast<uint8_t>(aeParticleType);
+	cell.uiFlags = uiTickParity;		// Spawned as already updated, so particles spawned mid-tick wait for the next tick
+	cell.iFuel = static_cast<int16_t>(rMaterial.iFuel);
+	if (rMaterial.eClass == PARTICLE_CLASS::LIQUID && rMaterial.bHeatSurroundings)
+	{
+		cell.iTemperature = FIRE_TEMP;
+		cell.uiFlags |= CA_FLAG_BURNING;
+	}
+	if (rMaterial.eClass == PARTICLE_CLASS::SOLID)
+	{
+		cell.uiFlags |= CA_FLAG_RESTING;
+	}
+	return cell;
+}
+
+/// <summary>
+/// Safely spawns a particle at a given spot in the simulation.
+/// </summary>
+/// <param name="aiX">The X position to spawn the new particle.</param>
+/// <param name="aiY">The Y position to spawn the new particle.</param>
+/// <param name="aeParticleType">The type of particle to spawn.</param>
+/// <remarks>No particle will be spawned if the given position is not within the simulation; nor if that position is already taken.</remarks>
+void ParticleSimulationCA::SpawnParticle(unsigned int aiX, unsigned int aiY, PARTICLE_TYPE aeParticleType)
+{
+	if (!IsPointWithinSimulation(aiX, aiY) || !IsCellEmpty(cellMap(aiX, aiY)) || materials[static_cast<int>(aeParticleType)].eClass == PARTICLE_CLASS::COUNT)
+	{
+		return;
+	}
+
+	cellMap(aiX, aiY) = CreateCell(aeParticleType);
+	++iParticleCount;
+	++iParticleAllocations;
+}
+
+/// <summary>
+/// Empties a given point in the simulation, waking its neighbors
+/// </summary>
+void ParticleSimulationCA::DestroyParticle(unsigned int aiX, unsigned int aiY)
+{
+	if (IsSpaceOccupied(aiX, aiY))
+	{
+		ExpireCell(aiX, aiY, static_cast<uint8_t>(PARTICLE_TYPE::NONE));
+	}
+}
+
+/// <summary>
+/// Notifys a particle in the simulation to ignite. Only powders and solids can be ignited.
+/// </summary>
+/// <param name="aiX">The X position of the target particle.</param>
+/// <param name="aiY">The Y position of the target particle.</param>
+void ParticleSimulationCA::IgniteParticle(unsigned int aiX, unsigned int aiY)
+{
+	if (!IsSpaceOccupied(aiX, aiY))
+	{
+		return;
+	}
+
+	CACell& rCell = cellMap(aiX, aiY);
+	const CAMaterial& rMaterial = materials[rCell.uiType];
+	if ((rMaterial.eClass == PARTICLE_CLASS::POWDER || rMaterial.eClass == PARTICLE_CLASS::SOLID) && !(rCell.uiFlags & CA_FLAG_BURNING))
+	{
+		rCell.iTemperature = rMaterial.eClass == PARTICLE_CLASS::POWDER ? rMaterial.iIgnitionTemperature : FIRE_TEMP;
+		rCell.uiFlags |= CA_FLAG_BURNING;
+		ForceWake(rCell);
+	}
+}
+
+/// <summary>
+/// Helper function to check if a given space is occupied.
+/// </summary>
+bool ParticleSimulationCA::IsSpaceOccupied(unsigned int aiX, unsigned int aiY)
+{
+	return IsPointWithinSimulation(aiX, aiY) && !IsCellEmpty(cellMap(aiX, aiY));
+}
+
+/// <summary>
+/// Caches the current state of each particle as a ParticleSnapshot, returning them in a SimulationSnapshot
+/// </summary>
+SimulationSnapshot ParticleSimulationCA::CreateSimulationSnapshot()
+{
+	SimulationSnapshot retVal = SimulationSnapshot();
+	for (int x = 0; x < iWidth; ++x)
+	{
+		for (int y = 0; y < iHeight; ++y)
+		{
+			const CACell& rCell = cellMap(x, y);
+			if (IsCellEmpty(rCell))
+			{
+				continue;
+			}
+
+			ParticleSnapshot snap = ParticleSnapshot();
+			snap.tType = static_cast<PARTICLE_TYPE>(rCell.uiType);
+			snap.iTemp = rCell.iTemperature;
+			snap.x = x;
+			snap.y = y;
+			retVal.cachedParticles.push_back(snap);
+		}
+	}
+	retVal.iWidth = iWidth;
+	retVal.iHeight = iHeight;
+
+	std::cout << "Snapshot taken!\n";
+	return retVal;
+}
+
+/// <summary>
+/// Removes every particle from the simulation
+/// </summary>
+void ParticleSimulationCA::ResetSimulation()
+{
+	cellMap.Fill(CACell());
+	iParticleCount = 0;
+}
+
+/// <summary>
+/// Removes every particle and spawns new ones based on a snapshot
+/// </summary>
+void ParticleSimulationCA::ResetSimulation(SimulationSnapshot asSnapshot)
+{
+	// Snapshots taken at a different size resize the simulation, which clears it as well
+	if (asSnapshot.iWidth > 0 && asSnapshot.iHeight > 0 && (asSnapshot.iWidth != iWidth || asSnapshot.iHeight != iHeight))
+	{
+		ResizeSimulation(asSnapshot.iWidth, asSnapshot.iHeight);
+	}
+	else
+	{
+		ResetSimulation();
+	}
+	for (ParticleSnapshot snap : asSnapshot.cachedParticles)
+	{
+		SpawnParticle(snap.x, snap.y, snap.tType);
+	}
+	std::cout << "Snapshot applied!\n";
+}
+
+/// <summary>
+/// Reallocates the simulation at a new size, deleting every particle
+/// </summary>
+/// <param name="aiWidth">Width of the simulation, in cells</param>
+/// <param name="aiHeight">Height of the simulation, in cells</param>
+/// <param name="abSparse">Unsupported - the CA engine has no chunks, so always stores the whole world. Asking for it is logged and the world is stored whole.</param>
+/// <remarks>Sizes over maxSimulationCellCount are rejected, leaving the simulation as it was.</remarks>
+void ParticleSimulationCA::ResizeSimulation(int aiWidth, int aiHeight, bool abSparse)
+{
+	if (aiWidth < 1 || aiHeight < 1 || static_cast<long long>(aiWidth) * aiHeight > maxSimulationCellCount)
+	{
+		std::cout << "Simulation size " << aiWidth << "x" << aiHeight << " is out of range!\n";
+		return;
+	}
+	if (abSparse)
+	{
+		std::cout << "The CA engine has no chunks, so can't store the world sparsely!\n";
+	}
+
+	iWidth = aiWidth;
+	iHeight = aiHeight;
+	cellMap.Resize(iWidth, iHeight, CACell(), eGridLayout, iGridTileSize);
+	iParticleCount = 0;
+}
+
+/// <summary>
+/// Changes the order the cell map stores its cells in, reallocating it and deleting every particle
+/// </summary>
+/// <param name="aeLayout">Order to store cells in</param>
+/// <param name="aiTileSize">Width and height of each tile, for the tiled layouts</param>
+void ParticleSimulationCA::SetGridLayout(GRID_LAYOUT aeLayout, int aiTileSize)
+{
+	eGridLayout = aeLayout;
+	iGridTileSize = aiTileSize;
+	ResizeSimulation(iWidth, iHeight);
+}
+
+/// <summary>
+/// Rejects turning class batching on, as the CA engine updates each cell by a switch on its class, with no virtual calls to batch
+/// </summary>
+/// <param name="abClassBatching">Whether to update each class of particle as a batch</param>
+void ParticleSimulationCA::SetClassBatching(bool abClassBatching)
+{
+	if (abClassBatching)
+	{
+		std::cout << "The CA engine updates every class of particle together, cell by cell, so can't batch them!\n";
+	}
+}
+
+/// <summary>
+/// Rejects every thread count over 1, as the CA engine always ticks on the calling thread
+/// </summary>
+/// <param name="aiThreadCount">Number of threads to tick on</param>
+void ParticleSimulationCA::SetThreadCount(int aiThreadCount)
+{
+	if (aiThreadCount > 1)
+	{
+		std::cout << "The CA engine can't tick on " << aiThreadCount << " threads, only the calling thread!\n";
+	}
+}
+
+/// <summary>
+/// Rejects streaming, as the CA engine has no chunks to page out, so always keeps the whole world resident
+/// </summary>
+/// <param name="asStoreDirectory">Directory the chunk store would have been kept in</param>
+/// <param name="aiResidentRadius">Radius in chunks that would have been kept resident</param>
+void ParticleSimulationCA::EnableStreaming(const std::string& asStoreDirectory, int aiResidentRadius)
+{
+	std::cout << "The CA engine has no chunks, so can't stream " << asStoreDirectory << " with a radius of " << aiResidentRadius << "!\n";
+}
+
+/// <summary>
+/// Moves a particle into a new cell, swapping with the occupant if displacement is allowed.
+/// </summary>
+/// <param name="aiX">X position of the particle, updated if the move succeeds</param>
+/// <param name="aiY">Y position of the particle, updated if the move succeeds</param>
+/// <returns>True if the move could be completed, false otherwise.</returns>
+bool ParticleSimulationCA::RequestCellMove(int& aiX, int& aiY, int aiNewX, int aiNewY)
+{
+	if (!IsPointWithinSimulation(aiNewX, aiNewY) || (aiNewX == aiX && aiNewY == aiY))
+	{
+		return false;
+	}
+
+	CACell& rSource = cellMap(aiX, aiY);
+	CACell& rTarget = cellMap(aiNewX, aiNewY);
+	if (!IsCellEmpty(rTarget))
+	{
+		// Special case: heavier materials can displace lighter ones, swapping with them
+		if (!materialRegistry.QCanDisplace(static_cast<PARTICLE_TYPE>(rSource.uiType), static_cast<PARTICLE_TYPE>(rTarget.uiType)))
+		{
+			return false;
+		}
+		std::swap(rSource, rTarget);
+	}
+	else
+	{
+		rTarget = rSource;
+		rSource = CACell();
+	}
+	// A swap changes what neighbours can move into as much as vacating a cell does, such as gases resting below the one that rose
+	WakeNeighboringCells(aiX, aiY);
+
+	rTarget.uiFlags |= CA_FLAG_MOVED;
+	aiX = aiNewX;
+	aiY = aiNewY;
+	return true;
+}
+
+/// <summary>
+/// Wakes any resting particles whose support or flow could change now that a cell has been vacated
+/// </summary>
+/// <remarks>Mirrors ParticleSimulation::WakeNeighboringParticles.</remarks>
+void ParticleSimulationCA::WakeNeighboringCells(int aiX, int aiY)
+{
+	for (int i = 0; i < wakeNeighborCount; ++i)
+	{
+		const int x = aiX + wakeNeighborOffsets[i][0];
+		const int y = aiY + wakeNeighborOffsets[i][1];
+		if (IsPointWithinSimulation(x, y))
+		{
+			CACell& rCell = cellMap(x, y);
+			if (!IsCellEmpty(rCell) && (rCell.uiFlags & CA_FLAG_RESTING))
+			{
+				ForceWake(rCell);
+				++iPixelsVisitted_Total;
+				++iPixelsVisitted_WakeChunk;
+			}
+		}
+	}
+}
+
+/// <summary>
+/// Using a DDA algorithm, trace a line from a particle's position to the end point, stopping at the first occupied cell.
+/// </summary>
+/// <remarks>Mirrors ParticleSimulationSoA::LineTest. Points outside of the simulation are treated as occupied, and cannot be displaced.</remarks>
+void ParticleSimulationCA::LineTest(int aiX, int aiY, int aiEndX, int aiEndY, int& aiHitPointX, int& aiHitPointY)
+{
+	const PARTICLE_TYPE eType = static_cast<PARTICLE_TYPE>(cellMap(aiX, aiY).uiType);
+
+	float fDeltaX = (aiEndX - aiX);
+	float fDeltaY = (aiEndY - aiY);
+
+	const float fStep = abs(fDeltaX) >= abs(fDeltaY) ? abs(fDeltaX) : abs(fDeltaY);
+
+	fDeltaX /= fStep;
+	fDeltaY /= fStep;
+
+	float fX = aiX;
+	float fY = aiY;
+	for (int i = 0; i <= fStep; ++i)
+	{
+		const int x = fX;
+		const int y = fY;
+		if (!IsPointWithinSimulation(x, y))
+		{
+			break;
+		}
+
+		const CACell& rCell = cellMap(x, y);
+		if ((x != aiX || y != aiY) && !IsCellEmpty(rCell))
+		{
+			if (materialRegistry.QCanDisplace(eType, static_cast<PARTICLE_TYPE>(rCell.uiType)))
+			{
+				aiHitPointX = x;
+				aiHitPointY = y;
+			}
+			break;
+		}
+
+		aiHitPointX = x;
+		aiHitPointY = y;
+		fX += fDeltaX;
+		fY += fDeltaY;
+	}
+}
+
+/// <summary>
+/// Raises the temperature of the four particles neighboring a point
+/// </summary>
+/// <remarks>Temperatures are held in 16 bits, so stop rising at SHRT_MAX.</remarks>
+void ParticleSimulationCA::HeatNeighboringCells(int aiX, int aiY, int aiTempStep)
+{
+	auto HeatFunctor = [this, aiTempStep](int aiTargetX, int aiTargetY)
+		{
+			if (IsSpaceOccupied(aiTargetX, aiTargetY))
+			{
+				CACell& rCell = cellMap(aiTargetX, aiTargetY);
+				rCell.iTemperature = static_cast<int16_t>(std::min(rCell.iTemperature + aiTempStep, SHRT_MAX));
+			}
+		};
+
+	HeatFunctor(aiX + 1, aiY);
+	HeatFunctor(aiX - 1, aiY);
+	HeatFunctor(aiX, aiY + 1);
+	HeatFunctor(aiX, aiY - 1);
+}
+
+/// <summary>
+/// Extinguishes any burning particles neighboring a point
+/// </summary>
+void ParticleSimulationCA::ExtinguishNeighboringCells(int aiX, int aiY)
+{
+	auto ExtinguishFunctor = [this](int aiTargetX, int aiTargetY)
+		{
+			if (IsSpaceOccupied(aiTargetX, aiTargetY))
+			{
+				CACell& rCell = cellMap(aiTargetX, aiTargetY);
+				if (rCell.uiFlags & CA_FLAG_BURNING)
+				{
+					rCell.uiFlags &= ~CA_FLAG_BURNING;
+					rCell.iTemperature *= 0.5f;
+				}
+			}
+		};
+
+	ExtinguishFunctor(aiX + 1, aiY);
+	ExtinguishFunctor(aiX - 1, aiY);
+	ExtinguishFunctor(aiX, aiY + 1);
+	ExtinguishFunctor(aiX, aiY - 1);
+}
+
+/// <summary>
+/// Forces a particle to wake. Powders also have their failed move attempts reset, matching ParticlePowder::ForceWake.
+/// </summary>
+void ParticleSimulationCA::ForceWake(CACell& arCell)
+{
+	arCell.uiFlags &= ~CA_FLAG_RESTING;
+	if (materials[arCell.uiType].eClass == PARTICLE_CLASS::POWDER)
+	{
+		arCell.uiFailedMoves = 0;
+	}
+}
+
+/// <summary>
+/// Helper function to detect a particle on the edge of a shape
+/// </summary>
+bool ParticleSimulationCA::IsParticleOnEdge(int aiX, int aiY)
+{
+	return (IsPointWithinSimulation(aiX + 1, aiY) && IsCellEmpty(cellMap(aiX + 1, aiY)))
+		|| (IsPointWithinSimulation(aiX - 1, aiY) && IsCellEmpty(cellMap(aiX - 1, aiY)))
+		|| (IsPointWithinSimulation(aiX, aiY + 1) && IsCellEmpty(cellMap(aiX, aiY + 1)))
+		|| (IsPointWithinSimulation(aiX, aiY - 1) && IsCellEmpty(cellMap(aiX, aiY - 1)));
+}
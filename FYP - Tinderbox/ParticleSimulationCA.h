@@ -0,0 +1,169 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+
+#include <cstdint>
+#include <ctime>
+#include <string>
+
+#include "ParticleSimulation.h"
+#include "ParticleSimulationSoA.h"
+#include "SimulationGrid.h"
+
+#define CA_FLAG_RESTING		0x01
+#define CA_FLAG_BURNING		0x02
+#define CA_FLAG_MOVED		0x04		// Moved during the last update, so drawn without its texture
+#define CA_FLAG_PARITY		0x08		// Matches uiTickParity once the cell has been updated this tick
+
+#define IS_CA_ACTIVE(FLAGS) \
+	(!((FLAGS) & CA_FLAG_RESTING) || ((FLAGS) & CA_FLAG_BURNING))
+
+/// <summary>
+/// A single cell of the cellular automaton engine. The whole state of the particle in the cell is held in the grid itself.
+/// </summary>
+struct CACell
+{
+	uint8_t uiType;				// PARTICLE_TYPE, NONE for an empty cell
+	uint8_t uiFlags;
+	uint8_t uiFailedMoves;
+	uint8_t uiTicksSinceCool;
+	int16_t iTemperature;
+	int16_t iFuel;				// Fuel for powders and solids, remaining lifetime for gases
+};
+
+static_assert(sizeof(CACell) == 8, "Cells are packed into 8 bytes, so a neighbour is always a single load away");
+
+/// <summary>
+/// Per-type constants for the cellular automaton engine, narrowed to fit alongside the packed cells
+/// </summary>
+struct CAMaterial
+{
+	PARTICLE_CLASS eClass = PARTICLE_CLASS::COUNT;
+	int iAttemptsBeforeRest = 0;
+	int iVelocityX = 0;
+	int iVelocityY = 0;
+	int iIgnitionTemperature = 0;
+	int iBurningFuelConsumption = 0;
+	int iFuel = 0;
+	int iMeltingPoint = -1;
+	int iFreezingTemperature = 0;
+	int iCoolingRate = 0;
+	uint8_t uiDeathParticleType = 0;
+	uint8_t uiFrozenParticleType = 0;
+	bool bShouldExtinguish = false;
+	bool bHeatSurroundings = false;
+};
+
+/// <summary>
+/// Alternative particle engine, running the simulation as a pure cellular automaton. Every cell of the grid is a packed CACell,
+/// so there are no per-particle heap objects and no ID indirection - every neighbour check is a single load from the grid.
+/// The grid is swept once per tick, with each particle updated in place. The movement and fire rules mirror ParticleSimulationSoA.
+/// </summary>
+/// <remarks>Expired particles are replaced as soon as they expire, rather than at the end of the tick.</remarks>
+class ParticleSimulationCA
+{
+public:
+	static ParticleSimulationCA& QInstance()
+	{
+		static ParticleSimulationCA instance;
+		return instance;
+	};
+
+	ParticleSimulationCA(int aiWidth = defaultSimulationWidth, int aiHeight = defaultSimulationHeight)
+	{
+		Initialize();
+		ResizeSimulation(aiWidth, aiHeight);
+		cClock = clock();
+	}
+
+	bool Tick(sf::Image& arCanvas);
+
+	void SpawnParticle(unsigned int aiX, unsigned int aiY, PARTICLE_TYPE aeParticleType);
+	void DestroyParticle(unsigned int aiX, unsigned int aiY);
+	void IgniteParticle(unsigned int aiX, unsigned int aiY);
+	bool IsSpaceOccupied(unsigned int aiX, unsigned int aiY);
+
+	SimulationSnapshot CreateSimulationSnapshot();
+	void ResetSimulation();
+	void ResetSimulation(SimulationSnapshot asSnapshot);
+	void ResizeSimulation(int aiWidth, int aiHeight, bool abSparse = false);
+
+	void SetTickPacing(bool abPaceTicks) { bPaceTicks = abPaceTicks; }
+	void SetGridLayout(GRID_LAYOUT aeLayout, int aiTileSize = defaultGridTileSize);
+	void SetClassBatching(bool abClassBatching);
+	void SetThreadCount(int aiThreadCount);
+	void EnableStreaming(const std::string& asStoreDirectory, int aiResidentRadius = defaultStreamingRadius);
+	void SetStreamingFocus(int, int) {}		// Never streaming, so there is no resident area to move
+
+	int QWidth() { return iWidth; }
+	int QHeight() { return iHeight; }
+	GRID_LAYOUT QGridLayout() { return eGridLayout; }
+	bool QClassBatching() { return false; }
+	bool QSparse() { return false; }							// The CA engine always stores the whole world
+	int QAllocatedChunkCount() { return 0; }
+	bool QStreaming() { return false; }
+	int QResidentChunkCount() { return 0; }
+	int QParticleCount() { return iParticleCount; }
+	int QActiveParticleCount() { return iActiveParticles; }
+	int QParticleVisitsTotal() { return iPixelsVisitted_Total; }
+	int QParticleVisitsRedraw() { return iPixelsVisitted_Redraw; }
+	int QParticleVisitsExpiredCleanup() { return 0; }
+	int QParticleVisitsChunkTick() { return iPixelsVisitted_ChunkTick; }
+	int QParticleVisitsWakeChunk() { return iPixelsVisitted_WakeChunk; }
+	int QChunkVisits() { return 0; }
+	int QBurningParticles() { return iBurningParticles; }
+	int QClassTickMicroseconds(PARTICLE_CLASS) { return 0; }		// Classes are updated together, cell by cell, so aren't timed apart
+	int QParticleAllocations() { return iParticleAllocations; }
+	int QParticleRecycles() { return 0; }
+	int QParticleFrees() { return iParticleFrees; }
+	int QPoolBlockAllocations() { return 0; }
+	int QThreadCount() { return 1; }
+
+protected:
+	void Initialize();
+	CACell CreateCell(PARTICLE_TYPE aeParticleType);
+
+	void UpdatePowder(int aiX, int aiY);
+	void UpdateLiquid(int aiX, int aiY);
+	void UpdateGas(int aiX, int aiY);
+	void UpdateSolid(int aiX, int aiY);
+	void ExpireCell(int aiX, int aiY, uint8_t auiReplacementType);
+	void DrawCells(sf::Image& arCanvas);
+
+	bool RequestCellMove(int& aiX, int& aiY, int aiNewX, int aiNewY);
+	void LineTest(int aiX, int aiY, int aiEndX, int aiEndY, int& aiHitPointX, int& aiHitPointY);
+	void HeatNeighboringCells(int aiX, int aiY, int aiTempStep);
+	void ExtinguishNeighboringCells(int aiX, int aiY);
+	void ForceWake(CACell& arCell);
+	void WakeNeighboringCells(int aiX, int aiY);
+
+	bool IsParticleOnEdge(int aiX, int aiY);
+	bool IsPointWithinSimulation(int aiX, int aiY) { return aiX >= 0 && aiY >= 0 && aiX < iWidth && aiY < iHeight; }
+	bool IsCellEmpty(const CACell& arCell) { return arCell.uiType == static_cast<uint8_t>(PARTICLE_TYPE::NONE); }
+
+private:
+	SimulationGrid<CACell> cellMap;
+	int iWidth = 0;
+	int iHeight = 0;
+	GRID_LAYOUT eGridLayout = GRID_LAYOUT::COLUMNS;
+	int iGridTileSize = defaultGridTileSize;
+
+	CAMaterial materials[static_cast<int>(PARTICLE_TYPE::COUNT)];
+	uint8_t uiTickParity = 0;		// Either 0 or CA_FLAG_PARITY, flipped every tick
+
+	int iPixelsVisitted_Total = 0;
+	int iPixelsVisitted_Redraw = 0;
+	int iPixelsVisitted_ChunkTick = 0;
+	int iPixelsVisitted_WakeChunk = 0;
+
+	// Particles only exist as cells, so allocations and frees count cells being filled and emptied
+	int iParticleAllocations = 0;
+	int iParticleFrees = 0;
+
+	clock_t cClock;
+	bool bPaceTicks = true;		// When false, every call to Tick runs a full tick rather than waiting for fFixedTickInterval
+
+	int iParticleCount = 0;
+	int iBurningParticles = 0;
+	int iActiveParticles = 0;		// Counted when drawing, as of the end of the last tick
+};
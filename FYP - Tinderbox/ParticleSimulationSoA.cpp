@@ -0,0 +1,878 @@
+#include "ParticleSimulationSoA.h"
+
+#include "ParticleColors.h"
+#include "ParticleMaterials.h"
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+#define CLASS_INDEX(CLASS) static_cast<int>(CLASS)
+
+/// <summary>
+/// Appends a new particle to the end of the arrays
+/// </summary>
+void ParticleArrays::Push(uint16_t auiX, uint16_t auiY, uint8_t auiType, int aiTemperature, int aiFuel, uint8_t auiFlags)
+{
+	x.push_back(auiX);
+	y.push_back(auiY);
+	type.push_back(auiType);
+	temperature.push_back(aiTemperature);
+	fuel.push_back(aiFuel);
+	flags.push_back(auiFlags);
+	failedMoves.push_back(0);
+	ticksSinceCool.push_back(0);
+	deathType.push_back(0);
+}
+
+/// <summary>
+/// Removes a particle by moving the last particle into its place
+/// </summary>
+void ParticleArrays::SwapRemove(int aiIndex)
+{
+	const int iLast = Size() - 1;
+	x[aiIndex] = x[iLast];
+	y[aiIndex] = y[iLast];
+	type[aiIndex] = type[iLast];
+	temperature[aiIndex] = temperature[iLast];
+	fuel[aiIndex] = fuel[iLast];
+	flags[aiIndex] = flags[iLast];
+	failedMoves[aiIndex] = failedMoves[iLast];
+	ticksSinceCool[aiIndex] = ticksSinceCool[iLast];
+	deathType[aiIndex] = deathType[iLast];
+
+	x.pop_back();
+	y.pop_back();
+	type.pop_back();
+	temperature.pop_back();
+	fuel.pop_back();
+	flags.pop_back();
+	failedMoves.pop_back();
+	ticksSinceCool.pop_back();
+	deathType.pop_back();
+}
+
+/// <summary>
+/// Removes every particle from the arrays
+/// </summary>
+void ParticleArrays::Clear()
+{
+	x.clear();
+	y.clear();
+	type.clear();
+	temperature.clear();
+	fuel.clear();
+	flags.clear();
+	failedMoves.clear();
+	ticksSinceCool.clear();
+	deathType.clear();
+}
+
+/// <summary>
+/// Handles the updating and drawing of particles, one particle class at a time.
+/// </summary>
+/// <param name="arCanvas">Reference to the sf::Image to draw the simulation onto.</param>
+/// <returns>True if a full tick was run, and the canvas has been redrawn.</returns>
+bool ParticleSimulationSoA::Tick(sf::Image& arCanvas)
+{
+	iPixelsVisitted_Total = 0;
+	iPixelsVisitted_ChunkTick = 0;
+	iPixelsVisitted_WakeChunk = 0;
+	iPixelsVisitted_ExpiredCleanup = 0;
+	iBurningParticles = 0;
+
+	clock_t cDeltaClock = clock() - cClock;
+	if (bPaceTicks && cDeltaClock <= fFixedTickInterval)
+	{
+		return false;
+	}
+	cClock = clock();
+	iParticleAllocations = 0;
+	iParticleFrees = 0;
+	iActiveParticles = 0;
+
+	// Every particle is redrawn each tick, so start from a clear canvas
+	arCanvas.create(iWidth, iHeight, COLOR_CLEAR);
+
+	auto TimedTickFunctor = [this, &arCanvas](PARTICLE_CLASS aeClass, void (ParticleSimulationSoA::*apTick)(sf::Image&))
+		{
+			const auto tStart = std::chrono::steady_clock::now();
+			(this->*apTick)(arCanvas);
+			classTickMicroseconds[CLASS_INDEX(aeClass)] = static_cast<int>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - tStart).count());
+		};
+
+	TimedTickFunctor(PARTICLE_CLASS::POWDER, &ParticleSimulationSoA::TickPowders);
+	TimedTickFunctor(PARTICLE_CLASS::LIQUID, &ParticleSimulationSoA::TickLiquids);
+	TimedTickFunctor(PARTICLE_CLASS::GAS, &ParticleSimulationSoA::TickGases);
+	TimedTickFunctor(PARTICLE_CLASS::SOLID, &ParticleSimulationSoA::TickSolids);
+
+	CleanupExpiredParticles();
+
+	return true;
+}
+
+/// <summary>
+/// Powder kernel - mirrors ParticlePowder::HandleMovement and ParticlePowder::HandleFireProperties
+/// </summary>
+void ParticleSimulationSoA::TickPowders(sf::Image& arCanvas)
+{
+	ParticleArrays& rPowders = particles[CLASS_INDEX(PARTICLE_CLASS::POWDER)];
+	const int iCount = rPowders.Size();
+	for (int i = 0; i < iCount; ++i)
+	{
+		const int x = rPowders.x[i];
+		const int y = rPowders.y[i];
+		const SoAMaterial& rMaterial = materials[rPowders.type[i]];
+
+		// Movement
+		if (!(rPowders.flags[i] & SOA_FLAG_RESTING) || (rPowders.flags[i] & SOA_FLAG_BURNING))
+		{
+			// First, attempt to move downwards
+			int iTargetX = x;
+			int iTargetY = y + rMaterial.iVelocityY;
+			LineTest(PARTICLE_CLASS::POWDER, i, iTargetX, iTargetY, iTargetX, iTargetY);
+			bool bMoved = RequestParticleMove(PARTICLE_CLASS::POWDER, i, iTargetX, iTargetY);
+			if (!bMoved)
+			{
+				// If that failed, attempt to move diagonally one way, then the other
+				iTargetY = y + 1;
+				iTargetX += 1;
+				bMoved = !IsSpaceOccupied(iTargetX, y) && RequestParticleMove(PARTICLE_CLASS::POWDER, i, iTargetX, iTargetY);
+				if (!bMoved)
+				{
+					iTargetX = x - 1;
+					bMoved = !IsSpaceOccupied(iTargetX, y) && RequestParticleMove(PARTICLE_CLASS::POWDER, i, iTargetX, iTargetY);
+				}
+			}
+
+			if (bMoved)
+			{
+				rPowders.failedMoves[i] = 0;
+			}
+			else if (++rPowders.failedMoves[i] >= rMaterial.iAttemptsBeforeRest)
+			{
+				rPowders.flags[i] |= SOA_FLAG_RESTING;
+			}
+		}
+
+		// Fire
+		if (rPowders.temperature[i] >= rMaterial.iIgnitionTemperature && !(rPowders.flags[i] & SOA_FLAG_BURNING))
+		{
+			rPowders.temperature[i] = rMaterial.iIgnitionTemperature;
+			rPowders.flags[i] |= SOA_FLAG_BURNING;
+			ForceWake(PARTICLE_CLASS::POWDER, i);
+		}
+		if (rPowders.flags[i] & SOA_FLAG_BURNING)
+		{
+			rPowders.temperature[i] = FIRE_TEMP;
+			rPowders.fuel[i] -= rMaterial.iBurningFuelConsumption;
+			if (rPowders.fuel[i] <= 0)
+			{
+				rPowders.flags[i] |= SOA_FLAG_EXPIRED;
+			}
+
+			++iBurningParticles;
+			HeatNeighboringParticles(rPowders.x[i], rPowders.y[i], rPowders.temperature[i] * 0.05f);
+		}
+
+		DrawParticle(arCanvas, PARTICLE_CLASS::POWDER, i, rPowders.x[i] != x || rPowders.y[i] != y);
+
+		iActiveParticles += IS_SOA_ACTIVE(rPowders.flags[i]);
+		++iPixelsVisitted_Total;
+		++iPixelsVisitted_ChunkTick;
+	}
+}
+
+/// <summary>
+/// Liquid kernel - mirrors ParticleLiquid::HandleMovement and ParticleLiquid::HandleFireProperties
+/// </summary>
+void ParticleSimulationSoA::TickLiquids(sf::Image& arCanvas)
+{
+	ParticleArrays& rLiquids = particles[CLASS_INDEX(PARTICLE_CLASS::LIQUID)];
+	const int iCount = rLiquids.Size();
+	for (int i = 0; i < iCount; ++i)
+	{
+		const int x = rLiquids.x[i];
+		const int y = rLiquids.y[i];
+		const SoAMaterial& rMaterial = materials[rLiquids.type[i]];
+
+		// Movement
+		if (!(rLiquids.flags[i] & SOA_FLAG_RESTING) || (rLiquids.flags[i] & SOA_FLAG_BURNING))
+		{
+			// First, attempt to move downwards
+			int iTargetX = x;
+			int iTargetY = y + rMaterial.iVelocityY;
+			LineTest(PARTICLE_CLASS::LIQUID, i, iTargetX, iTargetY, iTargetX, iTargetY);
+			bool bMoved = RequestParticleMove(PARTICLE_CLASS::LIQUID, i, iTargetX, iTargetY);
+			if (!bMoved)
+			{
+				// If that failed, attempt to move horizontally one way, then the other
+				LineTest(PARTICLE_CLASS::LIQUID, i, x + rMaterial.iVelocityX, y, iTargetX, iTargetY);
+				bMoved = RequestParticleMove(PARTICLE_CLASS::LIQUID, i, iTargetX, iTargetY);
+				if (!bMoved)
+				{
+					LineTest(PARTICLE_CLASS::LIQUID, i, x - rMaterial.iVelocityX, y, iTargetX, iTargetY);
+					bMoved = RequestParticleMove(PARTICLE_CLASS::LIQUID, i, iTargetX, iTargetY);
+				}
+			}
+
+			if (bMoved)
+			{
+				rLiquids.failedMoves[i] = 0;
+			}
+			else if (++rLiquids.failedMoves[i] >= rMaterial.iAttemptsBeforeRest)
+			{
+				rLiquids.flags[i] |= SOA_FLAG_RESTING;
+			}
+		}
+
+		// Fire
+		// Note: ParticleSimulation::ExtinguishParticle never reports success, so extinguishing never consumes the liquid
+		if (rMaterial.bShouldExtinguish)
+		{
+			ExtinguishNeighboringParticles(rLiquids.x[i], rLiquids.y[i]);
+		}
+
+		// Cooling/freezing behavior
+		if (rMaterial.iCoolingRate > 0)
+		{
+			if (rLiquids.ticksSinceCool[i] > rMaterial.iCoolingRate)
+			{
+				rLiquids.ticksSinceCool[i] = 0;
+				--rLiquids.temperature[i];
+				if (rLiquids.temperature[i] <= rMaterial.iFreezingTemperature)
+				{
+					rLiquids.deathType[i] = rMaterial.uiFrozenParticleType;
+					rLiquids.flags[i] |= SOA_FLAG_EXPIRED;
+				}
+			}
+			++rLiquids.ticksSinceCool[i];
+		}
+
+		if (rLiquids.flags[i] & SOA_FLAG_BURNING)
+		{
+			++iBurningParticles;
+			HeatNeighboringParticles(rLiquids.x[i], rLiquids.y[i], rLiquids.temperature[i] * 0.05f);
+		}
+
+		DrawParticle(arCanvas, PARTICLE_CLASS::LIQUID, i, rLiquids.x[i] != x || rLiquids.y[i] != y);
+
+		iActiveParticles += IS_SOA_ACTIVE(rLiquids.flags[i]);
+		++iPixelsVisitted_Total;
+		++iPixelsVisitted_ChunkTick;
+	}
+}
+
+/// <summary>
+/// Gas kernel - mirrors ParticleGas::HandleMovement and ParticleGas::HandleFireProperties
+/// </summary>
+void ParticleSimulationSoA::TickGases(sf::Image& arCanvas)
+{
+	ParticleArrays& rGases = particles[CLASS_INDEX(PARTICLE_CLASS::GAS)];
+	const int iCount = rGases.Size();
+	for (int i = 0; i < iCount; ++i)
+	{
+		const int x = rGases.x[i];
+		const int y = rGases.y[i];
+
+		// Movement - up, then either side
+		if (!(rGases.flags[i] & SOA_FLAG_RESTING))
+		{
+			if (!RequestParticleMove(PARTICLE_CLASS::GAS, i, x, y - 1)
+				&& !RequestParticleMove(PARTICLE_CLASS::GAS, i, x + 1, y)
+				&& !RequestParticleMove(PARTICLE_CLASS::GAS, i, x - 1, y))
+			{
+				rGases.flags[i] |= SOA_FLAG_RESTING;
+			}
+		}
+
+		// Lifetime
+		--rGases.fuel[i];
+		if (rGases.fuel[i] <= 0)
+		{
+			rGases.flags[i] |= SOA_FLAG_EXPIRED;
+		}
+
+		DrawParticle(arCanvas, PARTICLE_CLASS::GAS, i, rGases.x[i] != x || rGases.y[i] != y);
+
+		iActiveParticles += IS_SOA_ACTIVE(rGases.flags[i]);
+		++iPixelsVisitted_Total;
+		++iPixelsVisitted_ChunkTick;
+	}
+}
+
+/// <summary>
+/// Solid kernel - mirrors ParticleSolid::HandleMovement and ParticleSolid::HandleFireProperties
+/// </summary>
+void ParticleSimulationSoA::TickSolids(sf::Image& arCanvas)
+{
+	ParticleArrays& rSolids = particles[CLASS_INDEX(PARTICLE_CLASS::SOLID)];
+	const int iCount = rSolids.Size();
+	for (int i = 0; i < iCount; ++i)
+	{
+		const SoAMaterial& rMaterial = materials[rSolids.type[i]];
+		uint8_t& rFlags = rSolids.flags[i];
+		int& rTemperature = rSolids.temperature[i];
+
+		// Solids never move, they only settle once they stop burning
+		if (!(rFlags & SOA_FLAG_BURNING))
+		{
+			rFlags |= SOA_FLAG_RESTING;
+		}
+
+		// Melting
+		if (!(rFlags & SOA_FLAG_BURNING) && rMaterial.iMeltingPoint > 0 && rTemperature >= rMaterial.iMeltingPoint && rTemperature < rMaterial.iIgnitionTemperature)
+		{
+			rFlags |= SOA_FLAG_EXPIRED;
+		}
+
+		// Ignition
+		if (rTemperature >= rMaterial.iIgnitionTemperature && !(rFlags & SOA_FLAG_BURNING))
+		{
+			rTemperature = FIRE_TEMP;
+			rFlags |= SOA_FLAG_BURNING;
+			rFlags &= ~SOA_FLAG_RESTING;
+		}
+
+		// Burning
+		if (rFlags & SOA_FLAG_BURNING)
+		{
+			rTemperature = FIRE_TEMP;
+			rSolids.fuel[i] -= rMaterial.iBurningFuelConsumption;
+			if (rSolids.fuel[i] <= 0)
+			{
+				rSolids.deathType[i] = rMaterial.uiDeathParticleType;
+				rFlags |= SOA_FLAG_EXPIRED;
+			}
+
+			++iBurningParticles;
+			HeatNeighboringParticles(rSolids.x[i], rSolids.y[i], rTemperature * 0.05f);
+		}
+
+		DrawParticle(arCanvas, PARTICLE_CLASS::SOLID, i, false);
+		iActiveParticles += IS_SOA_ACTIVE(rFlags);
+
+		++iPixelsVisitted_Total;
+		++iPixelsVisitted_ChunkTick;
+	}
+}
+
+/// <summary>
+/// Removes every expired particle, spawning any death particles in their place, and wakes their neighbors
+/// </summary>
+void ParticleSimulationSoA::CleanupExpiredParticles()
+{
+	struct DeathParticle
+	{
+		int x, y;
+		PARTICLE_TYPE eType;
+	};
+	std::vector<DeathParticle> deathParticles;
+
+	for (int iClass = 0; iClass < CLASS_INDEX(PARTICLE_CLASS::COUNT); ++iClass)
+	{
+		ParticleArrays& rArrays = particles[iClass];
+
+		// Walk backwards, so the particle swapped into a removed slot has always been checked already
+		for (int i = rArrays.Size() - 1; i >= 0; --i)
+		{
+			if (!(rArrays.flags[i] & SOA_FLAG_EXPIRED))
+			{
+				continue;
+			}
+
+			const int x = rArrays.x[i];
+			const int y = rArrays.y[i];
+			if (rArrays.deathType[i] != static_cast<uint8_t>(PARTICLE_TYPE::NONE))
+			{
+				deathParticles.push_back({ x, y, static_cast<PARTICLE_TYPE>(rArrays.deathType[i]) });
+			}
+
+			cellMap(x, y) = SOA_EMPTY_CELL;
+			const int iLast = rArrays.Size() - 1;
+			if (i != iLast)
+			{
+				cellMap(rArrays.x[iLast], rArrays.y[iLast]) = SOA_CELL(iClass, i);
+			}
+			rArrays.SwapRemove(i);
+			++iParticleFrees;
+
+			// Wake any resting particles that could move into the space this particle left
+			WakeNeighboringParticles(x, y);
+
+			++iPixelsVisitted_Total;
+			++iPixelsVisitted_ExpiredCleanup;
+		}
+	}
+
+	for (const DeathParticle& rDeath : deathParticles)
+	{
+		SpawnParticle(rDeath.x, rDeath.y, rDeath.eType);
+	}
+}
+
+/// <summary>
+/// Copies the material registry into a single record per type
+/// </summary>
+void ParticleSimulationSoA::Initialize()
+{
+	for (const MaterialDefinition& rDefinition : materialDefinitions)
+	{
+		SoAMaterial& rMaterial = materials[static_cast<int>(rDefinition.eType)];
+		rMaterial.iAttemptsBeforeRest = rDefinition.iAttemptsBeforeRest;
+		rMaterial.iVelocityX = rDefinition.iVelocityX;
+		rMaterial.iVelocityY = rDefinition.iVelocityY;
+		rMaterial.iIgnitionTemperature = rDefinition.iIgnitionTemperature;
+		rMaterial.iBurningFuelConsumption = rDefinition.iBurningFuelConsumption;
+		rMaterial.iFuel = rDefinition.iFuel;
+		rMaterial.iMeltingPoint = rDefinition.iMeltingPoint;
+		rMaterial.iFreezingTemperature = rDefinition.iFreezingTemperature;
+		rMaterial.iCoolingRate = rDefinition.iCoolingRate;
+		rMaterial.uiDeathParticleType = static_cast<uint8_t>(rDefinition.eDeathType);
+		rMaterial.uiFrozenParticleType = static_cast<uint8_t>(rDefinition.eFrozenType);
+		rMaterial.bShouldExtinguish = rDefinition.bShouldExtinguish;
+		rMaterial.bHeatSurroundings = rDefinition.bHeatSurroundings;
+	}
+}
+
+/// <summary>
+/// Safely spawns a particle at a given spot in the simulation.
+/// </summary>
+/// <param name="aiX">The X position to spawn the new particle.</param>
+/// <param name="aiY">The Y position to spawn the new particle.</param>
+/// <param name="aeParticleType">The type of particle to spawn.</param>
+/// <remarks>No particle will be spawned if the given position is not within the simulation; nor if that position is already taken.</remarks>
+void ParticleSimulationSoA::SpawnParticle(unsigned int aiX, unsigned int aiY, PARTICLE_TYPE aeParticleType)
+{
+	if (!IsPointWithinSimulation(aiX, aiY) || cellMap(aiX, aiY) != SOA_EMPTY_CELL)
+	{
+		return;
+	}
+
+	const SoAMaterial& rMaterial = materials[static_cast<int>(aeParticleType)];
+	const PARTICLE_CLASS eClass = materialRegistry.QClass(aeParticleType);
+	int iTemperature = 0;
+	uint8_t uiFlags = 0;
+
+	if (eClass == PARTICLE_CLASS::LIQUID && rMaterial.bHeatSurroundings)
+	{
+		iTemperature = FIRE_TEMP;
+		uiFlags |= SOA_FLAG_BURNING;
+	}
+	if (eClass == PARTICLE_CLASS::SOLID)
+	{
+		uiFlags |= SOA_FLAG_RESTING;
+	}
+
+	if (eClass == PARTICLE_CLASS::COUNT)
+	{
+		return;
+	}
+
+	ParticleArrays& rArrays = particles[CLASS_INDEX(eClass)];
+	if (rArrays.Size() >= SOA_MAX_CLASS_PARTICLES)
+	{
+		return;
+	}
+	cellMap(aiX, aiY) = SOA_CELL(eClass, rArrays.Size());
+	rArrays.Push(aiX, aiY, static_cast<uint8_t>(aeParticleType), iTemperature, rMaterial.iFuel, uiFlags);
+	++iParticleAllocations;
+}
+
+/// <summary>
+/// Marks a given point in the simulation as expired - it will be deleted when the current tick cleans up any expired particles
+/// </summary>
+void ParticleSimulationSoA::DestroyParticle(unsigned int aiX, unsigned int aiY)
+{
+	if (IsSpaceOccupied(aiX, aiY))
+	{
+		const uint32_t uiCell = cellMap(aiX, aiY);
+		ParticleArrays& rArrays = particles[CLASS_INDEX(SOA_CELL_CLASS(uiCell))];
+		const int iIndex = SOA_CELL_INDEX(uiCell);
+		rArrays.flags[iIndex] |= SOA_FLAG_EXPIRED;
+		rArrays.deathType[iIndex] = static_cast<uint8_t>(PARTICLE_TYPE::NONE);
+	}
+}
+
+/// <summary>
+/// Notifys a particle in the simulation to ignite. Only powders and solids can be ignited.
+/// </summary>
+/// <param name="aiX">The X position of the target particle.</param>
+/// <param name="aiY">The Y position of the target particle.</param>
+void ParticleSimulationSoA::IgniteParticle(unsigned int aiX, unsigned int aiY)
+{
+	if (!IsSpaceOccupied(aiX, aiY))
+	{
+		return;
+	}
+
+	const uint32_t uiCell = cellMap(aiX, aiY);
+	const PARTICLE_CLASS eClass = SOA_CELL_CLASS(uiCell);
+	ParticleArrays& rArrays = particles[CLASS_INDEX(eClass)];
+	const int iIndex = SOA_CELL_INDEX(uiCell);
+
+	if ((eClass == PARTICLE_CLASS::POWDER || eClass == PARTICLE_CLASS::SOLID) && !(rArrays.flags[iIndex] & SOA_FLAG_BURNING))
+	{
+		rArrays.temperature[iIndex] = eClass == PARTICLE_CLASS::POWDER ? materials[rArrays.type[iIndex]].iIgnitionTemperature : FIRE_TEMP;
+		rArrays.flags[iIndex] |= SOA_FLAG_BURNING;
+		ForceWake(eClass, iIndex);
+	}
+}
+
+/// <summary>
+/// Helper function to check if a given space is occupied.
+/// </summary>
+bool ParticleSimulationSoA::IsSpaceOccupied(unsigned int aiX, unsigned int aiY)
+{
+	return IsPointWithinSimulation(aiX, aiY) && cellMap(aiX, aiY) != SOA_EMPTY_CELL;
+}
+
+/// <summary>
+/// Caches the current state of each particle as a ParticleSnapshot, returning them in a SimulationSnapshot
+/// </summary>
+SimulationSnapshot ParticleSimulationSoA::CreateSimulationSnapshot()
+{
+	SimulationSnapshot retVal = SimulationSnapshot();
+	for (const ParticleArrays& rArrays : particles)
+	{
+		for (int i = 0; i < rArrays.Size(); ++i)
+		{
+			ParticleSnapshot snap = ParticleSnapshot();
+			snap.tType = static_cast<PARTICLE_TYPE>(rArrays.type[i]);
+			snap.iTemp = rArrays.temperature[i];
+			snap.x = rArrays.x[i];
+			snap.y = rArrays.y[i];
+			retVal.cachedParticles.push_back(snap);
+		}
+	}
+	retVal.iWidth = iWidth;
+	retVal.iHeight = iHeight;
+
+	std::cout << "Snapshot taken!\n";
+	return retVal;
+}
+
+/// <summary>
+/// Removes every particle from the simulation
+/// </summary>
+void ParticleSimulationSoA::ResetSimulation()
+{
+	for (ParticleArrays& rArrays : particles)
+	{
+		rArrays.Clear();
+	}
+	cellMap.Fill(SOA_EMPTY_CELL);
+}
+
+/// <summary>
+/// Removes every particle and spawns new ones based on a snapshot
+/// </summary>
+void ParticleSimulationSoA::ResetSimulation(SimulationSnapshot asSnapshot)
+{
+	// Snapshots taken at a different size resize the simulation, which clears it as well
+	if (asSnapshot.iWidth > 0 && asSnapshot.iHeight > 0 && (asSnapshot.iWidth != iWidth || asSnapshot.iHeight != iHeight))
+	{
+		ResizeSimulation(asSnapshot.iWidth, asSnapshot.iHeight);
+	}
+	else
+	{
+		ResetSimulation();
+	}
+	for (ParticleSnapshot snap : asSnapshot.cachedParticles)
+	{
+		SpawnParticle(snap.x, snap.y, snap.tType);
+	}
+	std::cout << "Snapshot applied!\n";
+}
+
+/// <summary>
+/// Reallocates the simulation at a new size, deleting every particle
+/// </summary>
+/// <param name="aiWidth">Width of the simulation, in cells</param>
+/// <param name="aiHeight">Height of the simulation, in cells</param>
+/// <param name="abSparse">Unsupported - the SoA engine has no chunks, so always stores the whole world. Asking for it is logged and the world is stored whole.</param>
+/// <remarks>Sizes over maxSimulationCellCount are rejected, leaving the simulation as it was.</remarks>
+void ParticleSimulationSoA::ResizeSimulation(int aiWidth, int aiHeight, bool abSparse)
+{
+	if (aiWidth < 1 || aiHeight < 1 || static_cast<long long>(aiWidth) * aiHeight > maxSimulationCellCount)
+	{
+		std::cout << "Simulation size " << aiWidth << "x" << aiHeight << " is out of range!\n";
+		return;
+	}
+	if (abSparse)
+	{
+		std::cout << "The SoA engine has no chunks, so can't store the world sparsely!\n";
+	}
+
+	for (ParticleArrays& rArrays : particles)
+	{
+		rArrays.Clear();
+	}
+	iWidth = aiWidth;
+	iHeight = aiHeight;
+	cellMap.Resize(iWidth, iHeight, SOA_EMPTY_CELL, eGridLayout, iGridTileSize);
+}
+
+/// <summary>
+/// Changes the order the cell map stores its cells in, reallocating it and deleting every particle
+/// </summary>
+/// <param name="aeLayout">Order to store cells in</param>
+/// <param name="aiTileSize">Width and height of each tile, for the tiled layouts</param>
+void ParticleSimulationSoA::SetGridLayout(GRID_LAYOUT aeLayout, int aiTileSize)
+{
+	eGridLayout = aeLayout;
+	iGridTileSize = aiTileSize;
+	ResizeSimulation(iWidth, iHeight);
+}
+
+/// <summary>
+/// Rejects turning class batching off, as the SoA engine stores, and so always updates, each class of particle as a batch
+/// </summary>
+/// <param name="abClassBatching">Whether to update each class of particle as a batch</param>
+void ParticleSimulationSoA::SetClassBatching(bool abClassBatching)
+{
+	if (!abClassBatching)
+	{
+		std::cout << "The SoA engine always updates each class of particle as a batch!\n";
+	}
+}
+
+/// <summary>
+/// Rejects every thread count over 1, as the SoA engine always ticks on the calling thread
+/// </summary>
+/// <param name="aiThreadCount">Number of threads to tick on</param>
+void ParticleSimulationSoA::SetThreadCount(int aiThreadCount)
+{
+	if (aiThreadCount > 1)
+	{
+		std::cout << "The SoA engine can't tick on " << aiThreadCount << " threads, only the calling thread!\n";
+	}
+}
+
+/// <summary>
+/// Rejects streaming, as the SoA engine has no chunks to page out, so always keeps the whole world resident
+/// </summary>
+/// <param name="asStoreDirectory">Directory the chunk store would have been kept in</param>
+/// <param name="aiResidentRadius">Radius in chunks that would have been kept resident</param>
+void ParticleSimulationSoA::EnableStreaming(const std::string& asStoreDirectory, int aiResidentRadius)
+{
+	std::cout << "The SoA engine has no chunks, so can't stream " << asStoreDirectory << " with a radius of " << aiResidentRadius << "!\n";
+}
+
+/// <summary>
+/// Returns the total number of particles across every class
+/// </summary>
+int ParticleSimulationSoA::QParticleCount()
+{
+	int iCount = 0;
+	for (const ParticleArrays& rArrays : particles)
+	{
+		iCount += rArrays.Size();
+	}
+	return iCount;
+}
+
+/// <summary>
+/// Moves a particle into a new cell, swapping with the occupant if displacement is allowed.
+/// </summary>
+/// <returns>True if the move could be completed, false otherwise.</returns>
+/// <remarks>Unlike ParticleSimulation::RequestParticleMove, a displaced particle has its position updated along with the cell map.</remarks>
+bool ParticleSimulationSoA::RequestParticleMove(PARTICLE_CLASS aeClass, int aiIndex, int aiNewX, int aiNewY)
+{
+	if (!IsPointWithinSimulation(aiNewX, aiNewY))
+	{
+		return false;
+	}
+
+	ParticleArrays& rArrays = particles[CLASS_INDEX(aeClass)];
+	const int x = rArrays.x[aiIndex];
+	const int y = rArrays.y[aiIndex];
+	const uint32_t uiTargetCell = cellMap(aiNewX, aiNewY);
+
+	if (uiTargetCell != SOA_EMPTY_CELL)
+	{
+		// Special case: heavier materials can displace lighter ones, swapping with them
+		ParticleArrays& rDisplaced = particles[CLASS_INDEX(SOA_CELL_CLASS(uiTargetCell))];
+		const int iDisplacedIndex = SOA_CELL_INDEX(uiTargetCell);
+		if (!materialRegistry.QCanDisplace(static_cast<PARTICLE_TYPE>(rArrays.type[aiIndex]), static_cast<PARTICLE_TYPE>(rDisplaced.type[iDisplacedIndex])))
+		{
+			return false;
+		}
+
+		rDisplaced.x[iDisplacedIndex] = x;
+		rDisplaced.y[iDisplacedIndex] = y;
+		cellMap(x, y) = uiTargetCell;
+	}
+	else
+	{
+		cellMap(x, y) = SOA_EMPTY_CELL;
+		WakeNeighboringParticles(x, y);
+	}
+
+	cellMap(aiNewX, aiNewY) = SOA_CELL(aeClass, aiIndex);
+	rArrays.x[aiIndex] = aiNewX;
+	rArrays.y[aiIndex] = aiNewY;
+	return true;
+}
+
+/// <summary>
+/// Wakes any resting particles whose support or flow could change now that a cell has been vacated
+/// </summary>
+/// <remarks>Mirrors ParticleSimulation::WakeNeighboringParticles.</remarks>
+void ParticleSimulationSoA::WakeNeighboringParticles(int aiX, int aiY)
+{
+	for (int i = 0; i < wakeNeighborCount; ++i)
+	{
+		const int x = aiX + wakeNeighborOffsets[i][0];
+		const int y = aiY + wakeNeighborOffsets[i][1];
+		if (IsPointWithinSimulation(x, y) && cellMap(x, y) != SOA_EMPTY_CELL)
+		{
+			const PARTICLE_CLASS eClass = SOA_CELL_CLASS(cellMap(x, y));
+			const int iIndex = SOA_CELL_INDEX(cellMap(x, y));
+			if (particles[CLASS_INDEX(eClass)].flags[iIndex] & SOA_FLAG_RESTING)
+			{
+				ForceWake(eClass, iIndex);
+				++iPixelsVisitted_Total;
+				++iPixelsVisitted_WakeChunk;
+			}
+		}
+	}
+}
+
+/// <summary>
+/// Using a DDA algorithm, trace a line from the particle's position to the end point, stopping at the first occupied cell.
+/// </summary>
+/// <remarks>Mirrors ParticleSimulation::LineTest. Points outside of the simulation are treated as occupied, and cannot be displaced.</remarks>
+void ParticleSimulationSoA::LineTest(PARTICLE_CLASS aeClass, int aiIndex, int aiEndX, int aiEndY, int& aiHitPointX, int& aiHitPointY)
+{
+	const ParticleArrays& rArrays = particles[CLASS_INDEX(aeClass)];
+	const int iStartX = rArrays.x[aiIndex];
+	const int iStartY = rArrays.y[aiIndex];
+	const uint32_t uiSelfCell = SOA_CELL(aeClass, aiIndex);
+	const PARTICLE_TYPE eType = static_cast<PARTICLE_TYPE>(rArrays.type[aiIndex]);
+
+	float fDeltaX = (aiEndX - iStartX);
+	float fDeltaY = (aiEndY - iStartY);
+
+	const float fStep = abs(fDeltaX) >= abs(fDeltaY) ? abs(fDeltaX) : abs(fDeltaY);
+
+	fDeltaX /= fStep;
+	fDeltaY /= fStep;
+
+	float fX = iStartX;
+	float fY = iStartY;
+	for (int i = 0; i <= fStep; ++i)
+	{
+		const int x = fX;
+		const int y = fY;
+		if (!IsPointWithinSimulation(x, y))
+		{
+			break;
+		}
+
+		const uint32_t uiCell = cellMap(x, y);
+		if (uiCell != uiSelfCell && uiCell != SOA_EMPTY_CELL)
+		{
+			if (materialRegistry.QCanDisplace(eType, static_cast<PARTICLE_TYPE>(particles[CLASS_INDEX(SOA_CELL_CLASS(uiCell))].type[SOA_CELL_INDEX(uiCell)])))
+			{
+				aiHitPointX = x;
+				aiHitPointY = y;
+			}
+			break;
+		}
+
+		aiHitPointX = x;
+		aiHitPointY = y;
+		fX += fDeltaX;
+		fY += fDeltaY;
+	}
+}
+
+/// <summary>
+/// Raises the temperature of the four particles neighboring a point
+/// </summary>
+void ParticleSimulationSoA::HeatNeighboringParticles(int aiX, int aiY, int aiTempStep)
+{
+	auto HeatFunctor = [this, aiTempStep](int aiTargetX, int aiTargetY)
+		{
+			if (IsSpaceOccupied(aiTargetX, aiTargetY))
+			{
+				const uint32_t uiCell = cellMap(aiTargetX, aiTargetY);
+				particles[CLASS_INDEX(SOA_CELL_CLASS(uiCell))].temperature[SOA_CELL_INDEX(uiCell)] += aiTempStep;
+			}
+		};
+
+	HeatFunctor(aiX + 1, aiY);
+	HeatFunctor(aiX - 1, aiY);
+	HeatFunctor(aiX, aiY + 1);
+	HeatFunctor(aiX, aiY - 1);
+}
+
+/// <summary>
+/// Extinguishes any burning particles neighboring a point
+/// </summary>
+void ParticleSimulationSoA::ExtinguishNeighboringParticles(int aiX, int aiY)
+{
+	auto ExtinguishFunctor = [this](int aiTargetX, int aiTargetY)
+		{
+			if (IsSpaceOccupied(aiTargetX, aiTargetY))
+			{
+				const uint32_t uiCell = cellMap(aiTargetX, aiTargetY);
+				ParticleArrays& rArrays = particles[CLASS_INDEX(SOA_CELL_CLASS(uiCell))];
+				const int iIndex = SOA_CELL_INDEX(uiCell);
+				if (rArrays.flags[iIndex] & SOA_FLAG_BURNING)
+				{
+					rArrays.flags[iIndex] &= ~SOA_FLAG_BURNING;
+					rArrays.temperature[iIndex] *= 0.5f;
+				}
+			}
+		};
+
+	ExtinguishFunctor(aiX + 1, aiY);
+	ExtinguishFunctor(aiX - 1, aiY);
+	ExtinguishFunctor(aiX, aiY + 1);
+	ExtinguishFunctor(aiX, aiY - 1);
+}
+
+/// <summary>
+/// Draws a particle onto the canvas at its current position
+/// </summary>
+void ParticleSimulationSoA::DrawParticle(sf::Image& arCanvas, PARTICLE_CLASS aeClass, int aiIndex, bool abHasMoved)
+{
+	const ParticleArrays& rArrays = particles[CLASS_INDEX(aeClass)];
+	const int x = rArrays.x[aiIndex];
+	const int y = rArrays.y[aiIndex];
+
+	sf::Color cCol = ((rArrays.flags[aiIndex] & SOA_FLAG_BURNING) && aeClass != PARTICLE_CLASS::LIQUID)
+		? COLOR_FIRE
+		: ParticleSimulation::QInstance().GetParticleColor(static_cast<PARTICLE_TYPE>(rArrays.type[aiIndex]), x, y, !abHasMoved);
+	if (IsParticleOnEdge(x, y))
+	{
+		cCol.a = 170;
+	}
+	arCanvas.setPixel(x, y, cCol);
+}
+
+/// <summary>
+/// Forces a particle to wake. Powders also have their failed move attempts reset, matching ParticlePowder::ForceWake.
+/// </summary>
+void ParticleSimulationSoA::ForceWake(PARTICLE_CLASS aeClass, int aiIndex)
+{
+	ParticleArrays& rArrays = particles[CLASS_INDEX(aeClass)];
+	rArrays.flags[aiIndex] &= ~SOA_FLAG_RESTING;
+	if (aeClass == PARTICLE_CLASS::POWDER)
+	{
+		rArrays.failedMoves[aiIndex] = 0;
+	}
+}
+
+/// <summary>
+/// Helper function to detect a particle on the edge of a shape
+/// </summary>
+bool ParticleSimulationSoA::IsParticleOnEdge(int aiX, int aiY)
+{
+	return (IsPointWithinSimulation(aiX + 1, aiY) && cellMap(aiX + 1, aiY) == SOA_EMPTY_CELL)
+		|| (IsPointWithinSimulation(aiX - 1, aiY) && cellMap(aiX - 1, aiY) == SOA_EMPTY_CELL)
+		|| (IsPointWithinSimulation(aiX, aiY + 1) && cellMap(aiX, aiY + 1) == SOA_EMPTY_CELL)
+		|| (IsPointWithinSimulation(aiX, aiY - 1) && cellMap(aiX, aiY - 1) == SOA_EMPTY_CELL);
+}
@@ -0,0 +1,180 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <vector>
+
+#include "ParticleSimulation.h"
+#include "SimulationGrid.h"
+
+#define SOA_FLAG_RESTING	0x01
+#define SOA_FLAG_BURNING	0x02
+#define SOA_FLAG_EXPIRED	0x04
+
+#define IS_SOA_ACTIVE(FLAGS) \
+	(!((FLAGS) & SOA_FLAG_RESTING) || ((FLAGS) & SOA_FLAG_BURNING))
+
+// Cells in the SoA cell map pack the particle's class into the top byte, and its index + 1 into the rest. 0 is an empty cell.
+#define SOA_EMPTY_CELL 0u
+#define SOA_CELL(CLASS, INDEX) \
+	((static_cast<uint32_t>(CLASS) << 24) | static_cast<uint32_t>((INDEX) + 1))
+#define SOA_CELL_CLASS(CELL) \
+	static_cast<PARTICLE_CLASS>((CELL) >> 24)
+#define SOA_CELL_INDEX(CELL) \
+	(static_cast<int>((CELL) & 0x00FFFFFF) - 1)
+#define SOA_MAX_CLASS_PARTICLES 0x00FFFFFF		// Largest index + 1 that fits below the class byte
+
+/// <summary>
+/// Per-type constants, merged from the particle material tables so update kernels can index them by PARTICLE_TYPE
+/// </summary>
+struct SoAMaterial
+{
+	int iAttemptsBeforeRest = 0;
+	int iVelocityX = 0;
+	int iVelocityY = 0;
+	int iIgnitionTemperature = 0;
+	int iBurningFuelConsumption = 0;
+	int iFuel = 0;
+	int iMeltingPoint = -1;
+	int iFreezingTemperature = 0;
+	int iCoolingRate = 0;
+	uint8_t uiDeathParticleType = 0;
+	uint8_t uiFrozenParticleType = 0;
+	bool bShouldExtinguish = false;
+	bool bHeatSurroundings = false;
+};
+
+/// <summary>
+/// Parallel arrays holding the state of every particle of a single class
+/// </summary>
+struct ParticleArrays
+{
+	int Size() const { return static_cast<int>(type.size()); }
+	void Push(uint16_t auiX, uint16_t auiY, uint8_t auiType, int aiTemperature, int aiFuel, uint8_t auiFlags);
+	void SwapRemove(int aiIndex);
+	void Clear();
+
+	std::vector<uint16_t> x;
+	std::vector<uint16_t> y;
+	std::vector<uint8_t> type;
+	std::vector<int> temperature;
+	std::vector<int> fuel;					// Fuel for powders and solids, remaining lifetime for gases
+	std::vector<uint8_t> flags;
+	std::vector<uint16_t> failedMoves;
+	std::vector<uint16_t> ticksSinceCool;
+	std::vector<uint8_t> deathType;
+};
+
+/// <summary>
+/// Alternative particle engine, storing particle state as structure-of-arrays rather than as heap allocated Particle objects.
+/// Each particle class is stored in its own set of arrays and updated by its own kernel, with no virtual dispatch.
+/// The movement and fire rules mirror ParticlePowder, ParticleLiquid, ParticleGas and ParticleSolid.
+/// </summary>
+class ParticleSimulationSoA
+{
+public:
+	static ParticleSimulationSoA& QInstance()
+	{
+		static ParticleSimulationSoA instance;
+		return instance;
+	};
+
+	ParticleSimulationSoA(int aiWidth = defaultSimulationWidth, int aiHeight = defaultSimulationHeight)
+	{
+		Initialize();
+		ResizeSimulation(aiWidth, aiHeight);
+		cClock = clock();
+	}
+
+	bool Tick(sf::Image& arCanvas);
+
+	void SpawnParticle(unsigned int aiX, unsigned int aiY, PARTICLE_TYPE aeParticleType);
+	void DestroyParticle(unsigned int aiX, unsigned int aiY);
+	void IgniteParticle(unsigned int aiX, unsigned int aiY);
+	bool IsSpaceOccupied(unsigned int aiX, unsigned int aiY);
+
+	SimulationSnapshot CreateSimulationSnapshot();
+	void ResetSimulation();
+	void ResetSimulation(SimulationSnapshot asSnapshot);
+	void ResizeSimulation(int aiWidth, int aiHeight, bool abSparse = false);
+
+	void SetTickPacing(bool abPaceTicks) { bPaceTicks = abPaceTicks; }
+	void SetGridLayout(GRID_LAYOUT aeLayout, int aiTileSize = defaultGridTileSize);
+	void SetClassBatching(bool abClassBatching);
+	void SetThreadCount(int aiThreadCount);
+	void EnableStreaming(const std::string& asStoreDirectory, int aiResidentRadius = defaultStreamingRadius);
+	void SetStreamingFocus(int, int) {}		// Never streaming, so there is no resident area to move
+
+	int QWidth() { return iWidth; }
+	int QHeight() { return iHeight; }
+	GRID_LAYOUT QGridLayout() { return eGridLayout; }
+	bool QClassBatching() { return true; }
+	bool QSparse() { return false; }							// The SoA engine always stores the whole world
+	int QAllocatedChunkCount() { return 0; }
+	bool QStreaming() { return false; }
+	int QResidentChunkCount() { return 0; }
+	int QParticleCount();
+	int QActiveParticleCount() { return iActiveParticles; }
+	int QParticleVisitsTotal() { return iPixelsVisitted_Total; }
+	int QParticleVisitsRedraw() { return 0; }
+	int QParticleVisitsExpiredCleanup() { return iPixelsVisitted_ExpiredCleanup; }
+	int QParticleVisitsChunkTick() { return iPixelsVisitted_ChunkTick; }
+	int QParticleVisitsWakeChunk() { return iPixelsVisitted_WakeChunk; }
+	int QChunkVisits() { return 0; }
+	int QBurningParticles() { return iBurningParticles; }
+	int QClassTickMicroseconds(PARTICLE_CLASS aeClass) { return classTickMicroseconds[static_cast<int>(aeClass)]; }
+	int QParticleAllocations() { return iParticleAllocations; }
+	int QParticleRecycles() { return 0; }
+	int QParticleFrees() { return iParticleFrees; }
+	int QPoolBlockAllocations() { return 0; }
+	int QThreadCount() { return 1; }
+
+protected:
+	void Initialize();
+
+	void TickPowders(sf::Image& arCanvas);
+	void TickLiquids(sf::Image& arCanvas);
+	void TickGases(sf::Image& arCanvas);
+	void TickSolids(sf::Image& arCanvas);
+	void CleanupExpiredParticles();
+
+	bool RequestParticleMove(PARTICLE_CLASS aeClass, int aiIndex, int aiNewX, int aiNewY);
+	void LineTest(PARTICLE_CLASS aeClass, int aiIndex, int aiEndX, int aiEndY, int& aiHitPointX, int& aiHitPointY);
+	void HeatNeighboringParticles(int aiX, int aiY, int aiTempStep);
+	void ExtinguishNeighboringParticles(int aiX, int aiY);
+	void DrawParticle(sf::Image& arCanvas, PARTICLE_CLASS aeClass, int aiIndex, bool abHasMoved);
+	void ForceWake(PARTICLE_CLASS aeClass, int aiIndex);
+	void WakeNeighboringParticles(int aiX, int aiY);
+
+	bool IsParticleOnEdge(int aiX, int aiY);
+	bool IsPointWithinSimulation(int aiX, int aiY) { return aiX >= 0 && aiY >= 0 && aiX < iWidth && aiY < iHeight; }
+
+private:
+	SimulationGrid<uint32_t> cellMap;
+	int iWidth = 0;
+	int iHeight = 0;
+	GRID_LAYOUT eGridLayout = GRID_LAYOUT::COLUMNS;
+	int iGridTileSize = defaultGridTileSize;
+
+	ParticleArrays particles[static_cast<int>(PARTICLE_CLASS::COUNT)];
+	SoAMaterial materials[static_cast<int>(PARTICLE_TYPE::COUNT)];
+
+	int iPixelsVisitted_Total = 0;
+	int iPixelsVisitted_ChunkTick = 0;
+	int iPixelsVisitted_WakeChunk = 0;
+	int iPixelsVisitted_ExpiredCleanup = 0;
+	int classTickMicroseconds[static_cast<int>(PARTICLE_CLASS::COUNT)] = {};		// Time spent updating each class last tick
+
+	// Particles are stored by value, so allocations and frees count array pushes and removals
+	int iParticleAllocations = 0;
+	int iParticleFrees = 0;
+
+	clock_t cClock;
+	bool bPaceTicks = true;		// When false, every call to Tick runs a full tick rather than waiting for fFixedTickInterval
+
+	int iBurningParticles = 0;
+	int iActiveParticles = 0;		// Counted by the kernels as of the end of the last tick
+};
@@ -0,0 +1,64 @@
+#include "ParticleSlotMap.h"
+
+/// <summary>
+/// Removes the particle associated with a handle, freeing its memory.
+/// </summary>
+/// <param name="aiHandle">Handle of the particle to remove</param>
+/// <returns>True if the handle was valid and the particle was removed.</returns>
+/// <remarks>The last particle in the dense array is moved into the freed space, so iteration order is not preserved across erases.</remarks>
+bool ParticleSlotMap::Erase(int aiHandle)
+{
+	if (!Get(aiHandle))
+	{
+		return false;
+	}
+
+	const uint32_t uiSlotIndex = static_cast<uint32_t>(aiHandle) & slotIndexMask;
+	const uint32_t uiDenseIndex = slots[uiSlotIndex].uiDenseIndex;
+	const uint32_t uiLastDenseIndex = static_cast<uint32_t>(dense.size()) - 1;
+
+	// Swap the last particle into the hole, then pop
+	if (uiDenseIndex != uiLastDenseIndex)
+	{
+		dense[uiDenseIndex] = std::move(dense[uiLastDenseIndex]);
+		denseToSlot[uiDenseIndex] = denseToSlot[uiLastDenseIndex];
+		slots[denseToSlot[uiDenseIndex]].uiDenseIndex = uiDenseIndex;
+	}
+	dense.pop_back();
+	denseToSlot.pop_back();
+
+	// Bump the generation so any outstanding handles to this slot go stale
+	slots[uiSlotIndex].uiGeneration = slots[uiSlotIndex].uiGeneration >= slotGenerationMax ? 1 : slots[uiSlotIndex].uiGeneration + 1;
+	freeSlots.push_back(uiSlotIndex);
+	return true;
+}
+
+/// <summary>
+/// Removes every particle, invalidating all outstanding handles
+/// </summary>
+void ParticleSlotMap::Clear()
+{
+	dense.clear();
+	denseToSlot.clear();
+	freeSlots.clear();
+	for (uint32_t i = 0; i < slots.size(); ++i)
+	{
+		slots[i].uiGeneration = slots[i].uiGeneration >= slotGenerationMax ? 1 : slots[i].uiGeneration + 1;
+		freeSlots.push_back(i);
+	}
+}
+
+/// <summary>
+/// Returns the index of a free slot, reusing a released slot where possible
+/// </summary>
+uint32_t ParticleSlotMap::AcquireSlot()
+{
+	if (!freeSlots.empty())
+	{
+		const uint32_t uiSlotIndex = freeSlots.back();
+		freeSlots.pop_back();
+		return uiSlotIndex;
+	}
+	slots.push_back(Slot());
+	return static_cast<uint32_t>(slots.size()) - 1;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "Particle.h"
+#include "ParticlePool.h"
+
+// Handles are packed as [generation | slot index]. A generation of 0 is never issued, so a handle can never collide with NULL_PARTICLE_ID.
+constexpr uint32_t slotIndexBits = 24;
+constexpr uint32_t slotIndexMask = (1u << slotIndexBits) - 1;
+constexpr uint32_t slotGenerationMax = (1u << (32 - slotIndexBits)) - 1;
+
+/// <summary>
+/// Generational slot map for particle storage.
+/// Particles live contiguously in a dense array, and are referenced through stable 32-bit handles that can be stored in particleIDMap.
+/// Looking up a handle is two array reads - no hashing, and no reference counting.
+/// </summary>
+class ParticleSlotMap
+{
+public:
+	/// <summary>
+	/// Constructs a new particle of type T from the given pool, passing it its handle as the first constructor argument
+	/// </summary>
+	/// <returns>The handle of the new particle</returns>
+	template <typename T, typename... Args>
+	int Emplace(ParticlePool<T>& arPool, Args&&... aArgs)
+	{
+		const uint32_t uiSlotIndex = AcquireSlot();
+		const int iHandle = static_cast<int>((slots[uiSlotIndex].uiGeneration << slotIndexBits) | uiSlotIndex);
+
+		slots[uiSlotIndex].uiDenseIndex = static_cast<uint32_t>(dense.size());
+		dense.push_back(arPool.Acquire(iHandle, std::forward<Args>(aArgs)...));
+		denseToSlot.push_back(uiSlotIndex);
+		return iHandle;
+	}
+
+	/// <summary>
+	/// Returns the particle associated with a handle, or nullptr if the handle is null or stale
+	/// </summary>
+	Particle* Get(int aiHandle) const
+	{
+		const uint32_t uiHandle = static_cast<uint32_t>(aiHandle);
+		const uint32_t uiSlotIndex = uiHandle & slotIndexMask;
+		if (uiSlotIndex < slots.size() && slots[uiSlotIndex].uiGeneration == (uiHandle >> slotIndexBits))
+		{
+			return dense[slots[uiSlotIndex].uiDenseIndex].get();
+		}
+		return nullptr;
+	}
+
+	bool Erase(int aiHandle);
+	void Clear();
+
+	int Size() const { return static_cast<int>(dense.size()); }
+
+	std::vector<PooledParticlePtr>::iterator begin()	{ return dense.begin(); }
+	std::vector<PooledParticlePtr>::iterator end()		{ return dense.end(); }
+
+private:
+	struct Slot
+	{
+		uint32_t uiDenseIndex = 0;
+		uint32_t uiGeneration = 1;
+	};
+
+	uint32_t AcquireSlot();
+
+	std::vector<PooledParticlePtr> dense;
+	std::vector<uint32_t> denseToSlot;
+	std::vector<Slot> slots;
+	std::vector<uint32_t> freeSlots;
+};
@@ -4,7 +4,7 @@
 /// <summary>
 /// Handles the movement logic for this particle
 /// </summary>
-void ParticleSolid::HandleMovement()
+void ParticleSolid::HandleMovement(ParticleSimulation&)
 {
 	if (!QIsOnFire())
 	{
@@ -15,16 +15,16 @@ void ParticleSolid::HandleMovement()
 /// <summary>
 /// Handles the fire propogation logic for this particle
 /// </summary>
-void ParticleSolid::HandleFireProperties()
+void ParticleSolid::HandleFireProperties(ParticleSimulation&)
 {
 	// Melting
-	if (!QIsOnFire() && pProperties.iMeltingPoint > 0 && temperature >= pProperties.iMeltingPoint && temperature < pProperties.iIgnitionTemperature)
+	if (!QIsOnFire() && pProperties->iMeltingPoint > 0 && temperature >= pProperties->iMeltingPoint && temperature < pProperties->iIgnitionTemperature)
 	{
 		bExpired = true;
 	}
 
 	// Ignition
-	if (temperature >= pProperties.iIgnitionTemperature)
+	if (temperature >= pProperties->iIgnitionTemperature)
 	{
 		Ignite();
 	}
@@ -34,8 +34,8 @@ void ParticleSolid::HandleFireProperties()
 	{
 		temperature = FIRE_TEMP;
 
-		pProperties.iFuel -= pProperties.iBurningFuelConsumption;
-		if (pProperties.iFuel <= 0)
+		iFuel -= pProperties->iBurningFuelConsumption;
+		if (iFuel <= 0)
 		{
 			bExpired = true;
 		}
@@ -68,7 +68,7 @@ bool ParticleSolid::QHasLifetimeExpired()
 /// </summary>
 int ParticleSolid::QIgnitionTemperature()
 {
-	return pProperties.iIgnitionTemperature;
+	return pProperties->iIgnitionTemperature;
 }
 
 /// <summary>
@@ -76,10 +76,10 @@ int ParticleSolid::QIgnitionTemperature()
 /// </summary>
 int ParticleSolid::QFuel()
 {
-	return pProperties.iFuel;
+	return iFuel;
 }
 
 uint8_t ParticleSolid::QDeathParticleType()
 {
-	return bMelted || QFuel() <= 0 ? pProperties.uiMeltedParticleType : 0;
+	return bMelted || QFuel() <= 0 ? pProperties->uiMeltedParticleType : 0;
 }
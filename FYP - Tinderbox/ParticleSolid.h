@@ -4,14 +4,10 @@
 struct SolidProperties
 {
 	SolidProperties() = default;
-	SolidProperties(int aiIgnitionTemperature, int aiBurningFuelConsumption, int aiFuel, sf::Color acColor, int aiMeltingPoint, uint8_t auiMeltParticleType)
+	constexpr SolidProperties(int aiIgnitionTemperature, int aiBurningFuelConsumption, int aiFuel, uint32_t auiColor, int aiMeltingPoint, uint8_t auiMeltParticleType)
+		: iIgnitionTemperature(aiIgnitionTemperature), iMeltingPoint(aiMeltingPoint), uiMeltedParticleType(auiMeltParticleType),
+		iBurningFuelConsumption(aiBurningFuelConsumption), iFuel(aiFuel), uiColor(auiColor)
 	{
-		iIgnitionTemperature = aiIgnitionTemperature;
-		iBurningFuelConsumption = aiBurningFuelConsumption;
-		iFuel = aiFuel;
-		cColor = acColor;
-		uiMeltedParticleType = auiMeltParticleType;
-		iMeltingPoint = aiMeltingPoint;
 	}
 
 	int iIgnitionTemperature = 100;
@@ -19,33 +15,36 @@ struct SolidProperties
 	uint8_t uiMeltedParticleType = 0;
 	int iBurningFuelConsumption = 1;
 	int iFuel = 1000;
-	sf::Color cColor;
+	uint32_t uiColor = 0;	// Packed RGBA
 };
 
-class ParticleSolid : public Particle
+class ParticleSolid final : public Particle
 {
 public:
-	ParticleSolid(int aiID, unsigned int aiX, unsigned int aiY, uint8_t auiParticleType, SolidProperties apProperties)
+	ParticleSolid(int aiID, unsigned int aiX, unsigned int aiY, uint8_t auiParticleType, const SolidProperties* apProperties)
 	{
 		iParticleID = aiID;
 		uiParticleType = auiParticleType;
+		eClass = PARTICLE_CLASS::SOLID;
 		x = aiX;
 		y = aiY;
 		pProperties = apProperties;
-		cColor = pProperties.cColor;
+		iFuel = pProperties->iFuel;
 
 		bResting = true;
 	}
 
-	void HandleMovement() override;
-	void HandleFireProperties() override;
+	void HandleMovement(ParticleSimulation& arSimulation) override;
+	void HandleFireProperties(ParticleSimulation& arSimulation) override;
 	void Ignite() override;
 	bool QHasLifetimeExpired() override;
 	int QIgnitionTemperature() override;
 	int QFuel() override;
 	uint8_t QDeathParticleType() override;
+	sf::Color QColor() override { return sf::Color(pProperties->uiColor); }
 
 private:
 	bool bMelted = false;
-	SolidProperties pProperties;
+	const SolidProperties* pProperties;
+	int iFuel;
 };
@@ -26,7 +26,7 @@ struct PerfDatum
 class PerformanceReporter
 {
 public:
-	static PerformanceReporter& const QInstance()
+	static PerformanceReporter& QInstance()
 	{
 		static PerformanceReporter instance;
 		return instance;
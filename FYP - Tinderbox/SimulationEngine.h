@@ -0,0 +1,14 @@
+#pragma once
+
+// Define USE_SOA_ENGINE to drive the application with the structure-of-arrays engine, rather than the Particle object engine
+// Define USE_CA_ENGINE to drive it with the cellular automaton engine, which holds every particle directly in the grid
+#if defined(USE_SOA_ENGINE)
+#include "ParticleSimulationSoA.h"
+#define ACTIVE_SIMULATION ParticleSimulationSoA
+#elif defined(USE_CA_ENGINE)
+#include "ParticleSimulationCA.h"
+#define ACTIVE_SIMULATION ParticleSimulationCA
+#else
+#include "ParticleSimulation.h"
+#define ACTIVE_SIMULATION ParticleSimulation
+#endif
@@ -0,0 +1,390 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+
+constexpr size_t simulationGridAlignment = 64;		// Cache line size
+constexpr int defaultGridTileSize = 8;				// Width and height of a tile in the tiled layouts, in cells
+
+/// <summary>
+/// Order cells of a dense grid are stored in
+/// </summary>
+enum class GRID_LAYOUT : uint8_t
+{
+	COLUMNS,		// Column by column, so vertical neighbours are adjacent and horizontal neighbours are a column apart
+	TILES,			// Square tiles stored row by row, with the cells of each tile also stored row by row. Every neighbour of most cells is in the same few cache lines.
+	MORTON_TILES	// As TILES, but with tiles stored in Morton order, so neighbouring tiles are also close together
+};
+
+/// <summary>
+/// Heap allocated 2D grid of cells, sized at runtime. Storage is aligned to a cache line.
+/// By default, cells are stored column by column, matching the [x][y] layout of the fixed size arrays this replaced.
+/// Dense grids can instead be stored in tiles - see GRID_LAYOUT.
+/// </summary>
+/// <remarks>
+/// Every dense layout is found by adding a per-column offset to a per-row offset, both read from small tables.
+/// This lets the layout be chosen at runtime, with no branching on it when accessing a cell.
+/// A sparse grid instead splits the cells into square blocks, which are only allocated once something is written to them.
+/// Cells in an unallocated block read as the fill value, from a single shared block. Allocate must be called before writing to a cell.
+/// Either kind of grid can be given a border of cells around its edges, and cells inside it can be sealed. Border and sealed cells read as the border value,
+/// so probes a short distance past the edge of the grid need no bounds checks. They must never be written to.
+/// </remarks>
+template <typename T>
+class SimulationGrid
+{
+	static_assert(std::is_trivially_copyable<T>::value, "Grid cells are stored in raw memory, so must be trivially copyable");
+
+public:
+	/// <summary>
+	/// Reallocates the grid as a single dense block, setting every cell to aValue
+	/// </summary>
+	/// <param name="aeLayout">Order to store cells in</param>
+	/// <param name="aiTileSize">Width and height of each tile, for the tiled layouts. Rounded up to a power of two.</param>
+	/// <param name="aiBorder">Width of the border around the grid, in cells</param>
+	/// <param name="aBorderValue">Value every border cell reads as</param>
+	/// <remarks>Tiled grids are padded out to a whole number of tiles. The border is laid out as part of the grid, so tiles start at its outer edge.</remarks>
+	void Resize(int aiWidth, int aiHeight, const T& aValue = T(), GRID_LAYOUT aeLayout = GRID_LAYOUT::COLUMNS, int aiTileSize = defaultGridTileSize, int aiBorder = 0, const T& aBorderValue = T())
+	{
+		ReleaseBlocks();
+		iWidth = aiWidth;
+		iHeight = aiHeight;
+		iBorder = aiBorder;
+		borderValue = aBorderValue;
+		eLayout = aeLayout;
+		BuildLayoutOffsets(aiTileSize);
+
+		const size_t uiBytes = uiStorageCells * sizeof(T);
+		size_t uiSpace = uiBytes + simulationGridAlignment;
+		storage.reset(new unsigned char[uiSpace]);
+
+		void* pStart = storage.get();
+		pCells = static_cast<T*>(std::align(simulationGridAlignment, uiBytes, pStart, uiSpace));
+		Fill(aValue);
+	}
+
+	/// <summary>
+	/// Reallocates the grid as sparse blocks of aiBlockSize x aiBlockSize cells, none of which are allocated. Every cell reads as aValue.
+	/// </summary>
+	/// <remarks>aiBlockSize must be a power of two, and the width and height must be multiples of it.
+	/// Blocks are numbered row by row, so a block's index matches the ID of a chunk of the same size.
+	/// The border is a ring of blocks all sharing a single block of border cells, so must be no wider than a block.</remarks>
+	void ResizeSparse(int aiWidth, int aiHeight, int aiBlockSize, const T& aValue = T(), int aiBorder = 0, const T& aBorderValue = T())
+	{
+		storage.reset();
+		pCells = nullptr;
+		xOffsets.reset();
+		yOffsets.reset();
+		pXOffsets = nullptr;
+		pYOffsets = nullptr;
+		uiStorageCells = 0;
+		eLayout = GRID_LAYOUT::COLUMNS;
+		iWidth = aiWidth;
+		iHeight = aiHeight;
+		iBorder = aiBorder;
+		borderValue = aBorderValue;
+
+		iBlockShift = 0;
+		while ((1 << iBlockShift) < aiBlockSize)
+		{
+			++iBlockShift;
+		}
+		iBlockMask = aiBlockSize - 1;
+		iBlockCountX = aiWidth >> iBlockShift;
+		iBlockCount = iBlockCountX * (aiHeight >> iBlockShift);
+		iBlockRing = aiBorder > 0 ? 1 : 0;
+		iSlotCountX = iBlockCountX + (iBlockRing * 2);
+
+		emptyBlock.reset(new T[QBlockCellCount()]);
+		borderBlock.reset(new T[QBlockCellCount()]);
+		std::fill(borderBlock.get(), borderBlock.get() + QBlockCellCount(), aBorderValue);
+		ownedBlocks.reset(new std::unique_ptr<T[]>[iBlockCount]);
+
+		const int iSlotCount = iSlotCountX * ((aiHeight >> iBlockShift) + (iBlockRing * 2));
+		blocks.reset(new std::atomic<T*>[iSlotCount]);
+		for (int i = 0; i < iSlotCount; ++i)
+		{
+			blocks[i].store(borderBlock.get(), std::memory_order_relaxed);
+		}
+		for (int i = 0; i < iBlockCount; ++i)
+		{
+			blocks[QBlockSlot(i)].store(emptyBlock.get(), std::memory_order_relaxed);
+		}
+		iAllocatedBlocks = 0;
+		Fill(aValue);
+	}
+
+	/// <summary>
+	/// Sets every cell to aValue, leaving the border as it is. Sparse grids keep their allocated blocks, and unallocated blocks read as the new value.
+	/// </summary>
+	/// <remarks>Dense grids unseal every cell. Sparse grids keep any sealed blocks sealed.</remarks>
+	void Fill(const T& aValue)
+	{
+		fillValue = aValue;
+		if (!blocks)
+		{
+			std::fill(pCells, pCells + uiStorageCells, aValue);
+			FillBorder();
+			return;
+		}
+
+		std::fill(emptyBlock.get(), emptyBlock.get() + QBlockCellCount(), aValue);
+		for (int i = 0; i < iBlockCount; ++i)
+		{
+			if (ownedBlocks[i])
+			{
+				std::fill(ownedBlocks[i].get(), ownedBlocks[i].get() + QBlockCellCount(), aValue);
+			}
+		}
+	}
+
+	/// <summary>
+	/// Makes sure the block containing a cell is allocated, so the cell can be written to. Does nothing for dense grids.
+	/// </summary>
+	/// <remarks>Safe to call from several threads at once.</remarks>
+	void Allocate(int aiX, int aiY)
+	{
+		if (blocks)
+		{
+			const int iBlock = QBlockForPosition(aiX, aiY);
+			if (blocks[QBlockSlot(iBlock)].load(std::memory_order_acquire) == emptyBlock.get())
+			{
+				AllocateBlock(iBlock);
+			}
+		}
+	}
+
+	/// <summary>
+	/// Seals or unseals a square of aiSize x aiSize cells. Sealed cells read as the border value, and unsealed cells as the fill value.
+	/// </summary>
+	/// <remarks>The square must not hold anything but the fill value when sealed. In sparse grids, it must also be exactly one block, and sealing it frees the block.
+	/// Must not be called while any other thread is reading or writing the grid.</remarks>
+	void SetSquareSealed(int aiX, int aiY, int aiSize, bool abSealed)
+	{
+		if (blocks)
+		{
+			const int iBlock = QBlockForPosition(aiX, aiY);
+			if (ownedBlocks[iBlock])
+			{
+				ownedBlocks[iBlock].reset();
+				--iAllocatedBlocks;
+			}
+			blocks[QBlockSlot(iBlock)].store(abSealed ? borderBlock.get() : emptyBlock.get(), std::memory_order_relaxed);
+			return;
+		}
+
+		for (int x = aiX; x < aiX + aiSize; ++x)
+		{
+			for (int y = aiY; y < aiY + aiSize; ++y)
+			{
+				(*this)(x, y) = abSealed ? borderValue : fillValue;
+			}
+		}
+	}
+
+	/// <summary>
+	/// Frees a block if every cell in it holds the fill value, returning it to reading from the shared empty block
+	/// </summary>
+	/// <returns>True if the block was freed.</returns>
+	/// <remarks>Must not be called while any other thread is reading or writing the grid.</remarks>
+	bool ReleaseBlockIfEmpty(int aiBlock)
+	{
+		if (!blocks || !ownedBlocks[aiBlock])
+		{
+			return false;
+		}
+
+		const T* pBlock = ownedBlocks[aiBlock].get();
+		const T* pEmpty = emptyBlock.get();
+		if (!std::equal(pBlock, pBlock + QBlockCellCount(), pEmpty))
+		{
+			return false;
+		}
+
+		blocks[QBlockSlot(aiBlock)].store(emptyBlock.get(), std::memory_order_relaxed);
+		ownedBlocks[aiBlock].reset();
+		--iAllocatedBlocks;
+		return true;
+	}
+
+	// Cells up to the border's width past each edge can be read, returning the border value
+	T& operator()(int aiX, int aiY)					{ return blocks ? BlockCell(aiX, aiY) : pCells[pXOffsets[aiX] + pYOffsets[aiY]]; }
+	const T& operator()(int aiX, int aiY) const		{ return blocks ? BlockCell(aiX, aiY) : pCells[pXOffsets[aiX] + pYOffsets[aiY]]; }
+
+	int QWidth() const			{ return iWidth; }
+	int QHeight() const			{ return iHeight; }
+	int QBorder() const			{ return iBorder; }
+	size_t QCellCount() const	{ return static_cast<size_t>(iWidth) * iHeight; }
+
+	GRID_LAYOUT QLayout() const				{ return eLayout; }
+
+	bool QSparse() const					{ return blocks != nullptr; }
+	bool QBlockAllocated(int aiBlock) const	{ return blocks && ownedBlocks[aiBlock]; }
+	int QAllocatedBlockCount() const		{ return iAllocatedBlocks; }
+
+private:
+	/// <summary>
+	/// Spreads the bits of a value out to every other bit, for interleaving into a Morton index
+	/// </summary>
+	static size_t SpreadBits(size_t auiValue)
+	{
+		size_t uiSpread = 0;
+		for (int i = 0; auiValue >> i; ++i)
+		{
+			uiSpread |= ((auiValue >> i) & 1) << (i * 2);
+		}
+		return uiSpread;
+	}
+
+	/// <summary>
+	/// Fills the per-column and per-row offset tables for the current layout, and works out how many cells need storing.
+	/// The tables cover the border as well, and are indexed from the outer edge of the border.
+	/// </summary>
+	void BuildLayoutOffsets(int aiTileSize)
+	{
+		const int iLaidOutWidth = iWidth + (iBorder * 2);
+		const int iLaidOutHeight = iHeight + (iBorder * 2);
+		xOffsets.reset(new uint32_t[iLaidOutWidth]);
+		yOffsets.reset(new uint32_t[iLaidOutHeight]);
+		pXOffsets = xOffsets.get() + iBorder;
+		pYOffsets = yOffsets.get() + iBorder;
+
+		if (eLayout == GRID_LAYOUT::COLUMNS)
+		{
+			for (int x = 0; x < iLaidOutWidth; ++x)
+			{
+				xOffsets[x] = static_cast<uint32_t>(static_cast<size_t>(x) * iLaidOutHeight);
+			}
+			for (int y = 0; y < iLaidOutHeight; ++y)
+			{
+				yOffsets[y] = static_cast<uint32_t>(y);
+			}
+			uiStorageCells = static_cast<size_t>(iLaidOutWidth) * iLaidOutHeight;
+			return;
+		}
+
+		int iTileShift = 0;
+		while ((1 << iTileShift) < aiTileSize)
+		{
+			++iTileShift;
+		}
+		const size_t uiTileSize = static_cast<size_t>(1) << iTileShift;
+		const size_t uiTileCells = uiTileSize * uiTileSize;
+		const size_t uiTilesX = (iLaidOutWidth + uiTileSize - 1) >> iTileShift;
+		const size_t uiTilesY = (iLaidOutHeight + uiTileSize - 1) >> iTileShift;
+
+		// Tiles are grouped into squares, stored row by row. TILES uses squares of a single tile.
+		// MORTON_TILES uses the largest power of two square that fits, storing the tiles of each square in Morton order.
+		int iSquareShift = 0;
+		if (eLayout == GRID_LAYOUT::MORTON_TILES)
+		{
+			while ((static_cast<size_t>(2) << iSquareShift) <= std::min(uiTilesX, uiTilesY))
+			{
+				++iSquareShift;
+			}
+		}
+		const size_t uiSquareMask = (static_cast<size_t>(1) << iSquareShift) - 1;
+		const size_t uiSquareCells = uiTileCells << (iSquareShift * 2);
+		const size_t uiSquaresX = (uiTilesX + uiSquareMask) >> iSquareShift;
+		const size_t uiSquaresY = (uiTilesY + uiSquareMask) >> iSquareShift;
+
+		for (int x = 0; x < iLaidOutWidth; ++x)
+		{
+			const size_t uiTileX = static_cast<size_t>(x) >> iTileShift;
+			xOffsets[x] = static_cast<uint32_t>(((uiTileX >> iSquareShift) * uiSquareCells) + (SpreadBits(uiTileX & uiSquareMask) * uiTileCells) + (x & (uiTileSize - 1)));
+		}
+		for (int y = 0; y < iLaidOutHeight; ++y)
+		{
+			const size_t uiTileY = static_cast<size_t>(y) >> iTileShift;
+			yOffsets[y] = static_cast<uint32_t>(((uiTileY >> iSquareShift) * uiSquaresX * uiSquareCells) + ((SpreadBits(uiTileY & uiSquareMask) << 1) * uiTileCells) + ((y & (uiTileSize - 1)) << iTileShift));
+		}
+		uiStorageCells = uiSquaresX * uiSquaresY * uiSquareCells;
+	}
+
+	/// <summary>
+	/// Sets every cell of a dense grid's border to the border value
+	/// </summary>
+	void FillBorder()
+	{
+		for (int x = -iBorder; x < iWidth + iBorder; ++x)
+		{
+			for (int y = -iBorder; y < iHeight + iBorder; ++y)
+			{
+				if (x < 0 || y < 0 || x >= iWidth || y >= iHeight)
+				{
+					pCells[pXOffsets[x] + pYOffsets[y]] = borderValue;
+				}
+			}
+		}
+	}
+
+	int QBlockForPosition(int aiX, int aiY) const	{ return ((aiY >> iBlockShift) * iBlockCountX) + (aiX >> iBlockShift); }
+	int QBlockSlot(int aiBlock) const				{ return (((aiBlock / iBlockCountX) + iBlockRing) * iSlotCountX) + (aiBlock % iBlockCountX) + iBlockRing; }
+	size_t QBlockCellCount() const					{ return static_cast<size_t>(1) << (iBlockShift * 2); }
+
+	// Cells past the edge of the grid are in the ring of border blocks. Shifting a negative position rounds down, so lands in the ring.
+	T& BlockCell(int aiX, int aiY) const
+	{
+		T* pBlock = blocks[(((aiY >> iBlockShift) + iBlockRing) * iSlotCountX) + (aiX >> iBlockShift) + iBlockRing].load(std::memory_order_acquire);
+		return pBlock[((aiX & iBlockMask) << iBlockShift) + (aiY & iBlockMask)];
+	}
+
+	void AllocateBlock(int aiBlock)
+	{
+		std::lock_guard<std::mutex> lock(allocationMutex);
+		if (ownedBlocks[aiBlock])
+		{
+			return;		// Another thread got here first
+		}
+
+		ownedBlocks[aiBlock].reset(new T[QBlockCellCount()]);
+		std::copy(emptyBlock.get(), emptyBlock.get() + QBlockCellCount(), ownedBlocks[aiBlock].get());
+		blocks[QBlockSlot(aiBlock)].store(ownedBlocks[aiBlock].get(), std::memory_order_release);
+		++iAllocatedBlocks;
+	}
+
+	void ReleaseBlocks()
+	{
+		blocks.reset();
+		ownedBlocks.reset();
+		emptyBlock.reset();
+		borderBlock.reset();
+		iBlockCount = 0;
+		iAllocatedBlocks = 0;
+	}
+
+	// Dense storage. Dense grids are capped well below 2^32 cells, so offsets fit in 32 bits.
+	std::unique_ptr<unsigned char[]> storage;
+	T* pCells = nullptr;
+	std::unique_ptr<uint32_t[]> xOffsets;
+	std::unique_ptr<uint32_t[]> yOffsets;
+	const uint32_t* pXOffsets = nullptr;		// Offset tables, shifted past the border so they can be indexed by position
+	const uint32_t* pYOffsets = nullptr;
+	size_t uiStorageCells = 0;		// Cells allocated, including the border and any padding out to whole tiles
+	GRID_LAYOUT eLayout = GRID_LAYOUT::COLUMNS;
+
+	// Sparse storage. Every entry in blocks points at its owned block, at emptyBlock, or at borderBlock if it is sealed or part of the border.
+	// blocks is indexed by slot, which includes the ring of border blocks. Every other array is indexed by block.
+	std::unique_ptr<std::atomic<T*>[]> blocks;
+	std::unique_ptr<std::unique_ptr<T[]>[]> ownedBlocks;
+	std::unique_ptr<T[]> emptyBlock;
+	std::unique_ptr<T[]> borderBlock;
+	std::mutex allocationMutex;
+	std::atomic<int> iAllocatedBlocks{ 0 };
+	int iBlockShift = 0;
+	int iBlockMask = 0;
+	int iBlockCountX = 0;
+	int iBlockCount = 0;
+	int iBlockRing = 0;		// 1 if there is a ring of border blocks, otherwise 0
+	int iSlotCountX = 0;
+
+	int iWidth = 0;
+	int iHeight = 0;
+	int iBorder = 0;
+	T fillValue = T();
+	T borderValue = T();
+};
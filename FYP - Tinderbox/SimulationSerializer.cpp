@@ -5,14 +5,19 @@
 #include <fstream>
 #include <iostream>
 #include <string>
-#include <windows.h>
 #include <vector>
 
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
 #define SNAPSHOT_DATUM_SIZE 4
+#define SNAPSHOT_HEADER_SIZE 2
 
 /// <summary>
 /// Create a cache of the simulation, and save it to an external file. File is CSV formatted.
 /// </summary>
+/// <remarks>The first line holds the width and height of the simulation, and each line after holds a single particle.</remarks>
 void SimulationSerializer::SaveSimulation()
 {
 	CacheSimulation();
@@ -20,6 +25,7 @@ void SimulationSerializer::SaveSimulation()
 	{
 		std::ofstream simulationFile;
 		simulationFile.open("Simulation.txt");
+		simulationFile << std::to_string(cachedSimulation.iWidth) + "," + std::to_string(cachedSimulation.iHeight) + "\n";
 		for (ParticleSnapshot snap : cachedSimulation.cachedParticles)
 		{
 			std::string sLine = std::to_string(static_cast<int>(snap.tType)) + "," + std::to_string(snap.x) + "," + std::to_string(snap.y) + "," + std::to_string(snap.iTemp) + "\n";
@@ -33,10 +39,20 @@ void SimulationSerializer::SaveSimulation()
 /// Open the file browser and prompt the user to pick a simulation file. Parse that into a SimulationSnapshot and pass it to ApplySimulation()
 /// </summary>
 bool SimulationSerializer::LoadSimulation()
+{
+	return LoadSimulation(SelectFile());
+}
+
+/// <summary>
+/// Parse a simulation file into a SimulationSnapshot and pass it to ApplySimulation()
+/// </summary>
+/// <param name="asFilepath">Path to the simulation file to load</param>
+/// <returns>True if the file was loaded and applied.</returns>
+bool SimulationSerializer::LoadSimulation(const std::string& asFilepath)
 {
 	bool bRetVal = false;
     // Attempt to open a simulation snapshot
-    std::ifstream snapshotFile(SelectFile());
+    std::ifstream snapshotFile(asFilepath);
     if (snapshotFile.good())
     {
         // We were able to open the snaphot, parse each line
@@ -83,7 +99,13 @@ bool SimulationSerializer::LoadSimulation()
 					}
 				}
 
-				if (parsedStats.size() >= SNAPSHOT_DATUM_SIZE)
+				// Files saved before the world size was configurable have no header, and load at the current size
+				if (parsedStats.size() == SNAPSHOT_HEADER_SIZE)
+				{
+					simSnap.iWidth = parsedStats[0];
+					simSnap.iHeight = parsedStats[1];
+				}
+				else if (parsedStats.size() >= SNAPSHOT_DATUM_SIZE)
 				{
 					// Splitting this out rather than just using the constructor for clarity
 					ParticleSnapshot datum = ParticleSnapshot();
@@ -104,9 +126,14 @@ bool SimulationSerializer::LoadSimulation()
 	return bRetVal;
 }
 
+/// <summary>
+/// Open the file browser and prompt the user to pick a file
+/// </summary>
+/// <returns>The selected filepath, or an empty string if no file was selected. Always empty outside of Windows.</returns>
 std::string SimulationSerializer::SelectFile()
 {
     std::string retVal = "";
+#ifdef _WIN32
     OPENFILENAME ofn;
     TCHAR szFile[260] = { 0 };
     ZeroMemory(&ofn, sizeof(ofn));
@@ -125,6 +152,7 @@ std::string SimulationSerializer::SelectFile()
         std::wstring_convert<std::codecvt_utf8_utf16<wchar_t> > converter;
         retVal = converter.to_bytes(std::wstring(ofn.lpstrFile));
     }
+#endif
 
     return retVal;
 }
@@ -134,7 +162,7 @@ std::string SimulationSerializer::SelectFile()
 /// </summary>
 void SimulationSerializer::CacheSimulation()
 {
-	cachedSimulation = ParticleSimulation::QInstance().CreateSimulationSnapshot();
+	cachedSimulation = ACTIVE_SIMULATION::QInstance().CreateSimulationSnapshot();
 }
 
 /// <summary>
@@ -142,5 +170,5 @@ void SimulationSerializer::CacheSimulation()
 /// </summary>
 void SimulationSerializer::ApplySimulation()
 {
-	ParticleSimulation::QInstance().ResetSimulation(cachedSimulation);
+	ACTIVE_SIMULATION::QInstance().ResetSimulation(cachedSimulation);
 }
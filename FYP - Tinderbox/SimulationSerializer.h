@@ -1,13 +1,15 @@
 #pragma once
 
-#include "ParticleSimulation.h"
+#include <string>
+
+#include "SimulationEngine.h"
 
 class Particle;
 
 class SimulationSerializer
 {
 public:
-	static SimulationSerializer& const QInstance()
+	static SimulationSerializer& QInstance()
 	{
 		static SimulationSerializer instance;
 		return instance;
@@ -15,6 +17,7 @@ public:
 
 	void SaveSimulation();
 	bool LoadSimulation();
+	bool LoadSimulation(const std::string& asFilepath);
 
 	std::string SelectFile();
 
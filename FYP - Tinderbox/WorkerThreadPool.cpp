@@ -0,0 +1,107 @@
+#include "WorkerThreadPool.h"
+
+/// <summary>
+/// Creates the pool, and starts its worker threads
+/// </summary>
+/// <param name="aiWorkerCount">Number of threads to create, not counting the thread that calls Run.</param>
+WorkerThreadPool::WorkerThreadPool(int aiWorkerCount)
+{
+	iNextJob = 0;
+	for (int i = 0; i < aiWorkerCount; ++i)
+	{
+		workers.emplace_back([this]() { WorkerLoop(); });
+	}
+}
+
+/// <summary>
+/// Wakes and joins every worker thread
+/// </summary>
+WorkerThreadPool::~WorkerThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(batchLock);
+		bShuttingDown = true;
+	}
+	batchStarted.notify_all();
+
+	for (std::thread& worker : workers)
+	{
+		worker.join();
+	}
+}
+
+/// <summary>
+/// Runs afJob once for every index in [0, aiJobCount), spread across the pool and the calling thread.
+/// Acts as a barrier - returns only once every job has finished.
+/// </summary>
+void WorkerThreadPool::Run(int aiJobCount, const std::function<void(int)>& afJob)
+{
+	{
+		std::lock_guard<std::mutex> lock(batchLock);
+		pJob = &afJob;
+		iJobCount = aiJobCount;
+		iNextJob = 0;
+		iBusyWorkers = static_cast<int>(workers.size());
+		++uiBatch;
+	}
+	batchStarted.notify_all();
+
+	RunJobs();
+
+	// Wait for every worker to check in before the job goes out of scope
+	std::unique_lock<std::mutex> lock(batchLock);
+	batchFinished.wait(lock, [this]() { return iBusyWorkers == 0; });
+	pJob = nullptr;
+}
+
+/// <summary>
+/// Returns a worker count that, along with the calling thread, fills the available hardware threads
+/// </summary>
+int WorkerThreadPool::QHardwareWorkerCount()
+{
+	const int iHardwareThreads = static_cast<int>(std::thread::hardware_concurrency());
+	return iHardwareThreads > 1 ? iHardwareThreads - 1 : 0;
+}
+
+/// <summary>
+/// Main loop for each worker - sleeps until a new batch is started, then helps run it
+/// </summary>
+void WorkerThreadPool::WorkerLoop()
+{
+	uint64_t uiLastBatch = 0;
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(batchLock);
+			batchStarted.wait(lock, [this, uiLastBatch]() { return bShuttingDown || uiBatch != uiLastBatch; });
+			if (bShuttingDown)
+			{
+				return;
+			}
+			uiLastBatch = uiBatch;
+		}
+
+		RunJobs();
+
+		bool bLastWorker = false;
+		{
+			std::lock_guard<std::mutex> lock(batchLock);
+			bLastWorker = --iBusyWorkers == 0;
+		}
+		if (bLastWorker)
+		{
+			batchFinished.notify_one();
+		}
+	}
+}
+
+/// <summary>
+/// Claims and runs jobs from the current batch until none are left
+/// </summary>
+void WorkerThreadPool::RunJobs()
+{
+	for (int iJob = iNextJob++; iJob < iJobCount; iJob = iNextJob++)
+	{
+		(*pJob)(iJob);
+	}
+}
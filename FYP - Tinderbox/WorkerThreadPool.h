@@ -0,0 +1,43 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// <summary>
+/// Persistent pool of worker threads. Threads are created once, and sleep between batches of work.
+/// The calling thread joins in on each batch, so a pool of N threads runs jobs on N + 1 threads.
+/// </summary>
+class WorkerThreadPool
+{
+public:
+	WorkerThreadPool(int aiWorkerCount);
+	~WorkerThreadPool();
+
+	void Run(int aiJobCount, const std::function<void(int)>& afJob);
+
+	int QThreadCount() const { return static_cast<int>(workers.size()) + 1; }
+
+	static int QHardwareWorkerCount();
+
+private:
+	void WorkerLoop();
+	void RunJobs();
+
+	std::vector<std::thread> workers;
+
+	std::mutex batchLock;
+	std::condition_variable batchStarted;
+	std::condition_variable batchFinished;
+
+	const std::function<void(int)>* pJob = nullptr;
+	int iJobCount = 0;
+	std::atomic<int> iNextJob;
+	int iBusyWorkers = 0;
+	uint64_t uiBatch = 0;
+	bool bShuttingDown = false;
+};
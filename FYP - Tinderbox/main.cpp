@@ -1,17 +1,19 @@
+#include <algorithm>
+#include <cstdlib>
 #include <iostream>
+#include <string>
 #include <thread>
 
 #include <SFML/Graphics.hpp>
 
-#include "ParticleSimulation.h"
+#include "ParticleColors.h"
+#include "SimulationEngine.h"
 #include "PerformanceReporter.h"
 #include "SimulationSerializer.h"
 #include "UIButton.h"
 
 #define SCREEN_RESOLUTION 900
-#define CANVAS_SCALE_FACTOR ((float)SCREEN_RESOLUTION / (float)simulationResolution)
-
-#define SCREEN_CLEAR_COLOUR sf::Color(13,14,15,255)
+#define CANVAS_SCALE_FACTOR ((float)SCREEN_RESOLUTION / (float)std::max(ACTIVE_SIMULATION::QInstance().QWidth(), ACTIVE_SIMULATION::QInstance().QHeight()))
 
 #define UI_TOOLBAR_X_PADDING 16
 #define UI_TOOLBAR_Y_PADDING 38
@@ -96,8 +98,20 @@ enum class TOOLBAR_BUTTONS : uint8_t
 };
 UIButton* ToolBar[static_cast<int>(TOOLBAR_BUTTONS::COUNT)];
 
-int main()
+int main(int argc, char* argv[])
 {
+	// The world size can be given on the command line, as "Tinderbox [width height [sparse|stream]]"
+	// Streaming worlds are sparse, and page chunks away from the mouse out to disk
+	if (argc > 2)
+	{
+		const std::string sStorage = argc > 3 ? argv[3] : "";
+		ACTIVE_SIMULATION::QInstance().ResizeSimulation(std::atoi(argv[1]), std::atoi(argv[2]), sStorage == "sparse" || sStorage == "stream");
+		if (sStorage == "stream")
+		{
+			ACTIVE_SIMULATION::QInstance().EnableStreaming("ChunkStore");
+		}
+	}
+
 	// Help message to better explain program use
 	std::cout << "====================" << std::endl;
 	std::cout << "Welcome to Tinderbox" << std::endl;
@@ -106,10 +120,12 @@ int main()
 	std::cout << "1-0: Element bindings" << std::endl;
 	std::cout << "F1: Show performance metrics" << std::endl;
 	std::cout << "F2: Show chunk boundaries" << std::endl;
+	std::cout << "F3: Toggle batching particles by class" << std::endl;
 	std::cout << "F9: Brush size 1" << std::endl;
 	std::cout << "F10: Brush size 3" << std::endl;
 	std::cout << "F11: Brush size 5" << std::endl;
 	std::cout << "F12: Brush size 7" << std::endl;
+	std::cout << "\nWorld size: " << ACTIVE_SIMULATION::QInstance().QWidth() << "x" << ACTIVE_SIMULATION::QInstance().QHeight() << (ACTIVE_SIMULATION::QInstance().QStreaming() ? " (streaming)" : ACTIVE_SIMULATION::QInstance().QSparse() ? " (sparse)" : "") << std::endl;
 	std::cout << "\n" << std::endl;
 
 	sf::RenderWindow wWindow(sf::VideoMode(SCREEN_RESOLUTION, SCREEN_RESOLUTION), "Tinderbox");
@@ -125,13 +141,22 @@ int main()
 	DEFINE_DEBUG_STAT_TEXT(ActiveParticlesCount, 8, 48, "");
 	DEFINE_DEBUG_STAT_TEXT(TotalParticlesCount, 8, 64, "");
 	DEFINE_DEBUG_STAT_TEXT(ParticleVisitsCountTotal, 8, 80, "");
-	DEFINE_DEBUG_STAT_TEXT(ParticleVisitsCountPreChunk, 24, 96, "");
+	DEFINE_DEBUG_STAT_TEXT(ParticleVisitsCountRedraw, 24, 96, "");
 	DEFINE_DEBUG_STAT_TEXT(ParticleVisitsCountChunkTick, 24, 112, "");
 	DEFINE_DEBUG_STAT_TEXT(ParticleVisitsCountWakeChunk, 24, 128, "");
-	DEFINE_DEBUG_STAT_TEXT(ParticleVisitsCountAllowUpdate, 24, 144, "");
-	DEFINE_DEBUG_STAT_TEXT(ParticleVisitsCountExpiredCleanup, 24, 160, "");
-	DEFINE_DEBUG_STAT_TEXT(ChunkVisitsCount, 8, 176, "");
-	DEFINE_DEBUG_STAT_TEXT(BurningParticles, 8, 192, "");
+	DEFINE_DEBUG_STAT_TEXT(ParticleVisitsCountExpiredCleanup, 24, 144, "");
+	DEFINE_DEBUG_STAT_TEXT(ChunkVisitsCount, 8, 160, "");
+	DEFINE_DEBUG_STAT_TEXT(BurningParticles, 8, 176, "");
+	DEFINE_DEBUG_STAT_TEXT(ParticleAllocations, 8, 192, "");
+	DEFINE_DEBUG_STAT_TEXT(ParticleRecycles, 24, 208, "");
+	DEFINE_DEBUG_STAT_TEXT(ParticleFrees, 8, 224, "");
+	DEFINE_DEBUG_STAT_TEXT(PoolBlockAllocations, 8, 240, "");
+	DEFINE_DEBUG_STAT_TEXT(AllocatedChunks, 8, 256, "");
+	DEFINE_DEBUG_STAT_TEXT(ResidentChunks, 8, 272, "");
+	DEFINE_DEBUG_STAT_TEXT(PowderTickMicroseconds, 8, 288, "");
+	DEFINE_DEBUG_STAT_TEXT(LiquidTickMicroseconds, 8, 304, "");
+	DEFINE_DEBUG_STAT_TEXT(GasTickMicroseconds, 8, 320, "");
+	DEFINE_DEBUG_STAT_TEXT(SolidTickMicroseconds, 8, 336, "");
 	// -------------------
 
 	// UI Setup
@@ -266,48 +291,79 @@ int main()
 	int iTicksPerPerfCapture = 100;
 	int iTicksUntilPerfCapture = iTicksPerPerfCapture;
 
+	// Create our canvas image
+	// We need an sf::Image as that provides the easiest access to an array of pixel data
+	// This single image is then scaled up to fill the screen
+	// The simulation only redraws cells that changed, so the canvas persists between frames
 	imCanvas = new sf::Image;
+	imCanvas->create(ACTIVE_SIMULATION::QInstance().QWidth(), ACTIVE_SIMULATION::QInstance().QHeight(), COLOR_CLEAR);
 
 	while (wWindow.isOpen())
 	{
 		currentTicks = clock();
 
 		// Display important profiling information
-		const int iParticleCount = ParticleSimulation::QInstance().QParticleCount();
-		const int iactiveParticles = ParticleSimulation::QInstance().QActiveParticleCount();
-		const int iparticleVisitsTotal = ParticleSimulation::QInstance().QParticleVisitsTotal();
-		const int iparticleVisitsPreChunk = ParticleSimulation::QInstance().QParticleVisitsPreChunk();
-		const int iparticleVisitsChunkTick = ParticleSimulation::QInstance().QParticleVisitsChunkTick();
-		const int iparticleVisitsWakeChunk = ParticleSimulation::QInstance().QParticleVisitsWakeChunk();
-		const int iparticleVisitsAllowUpdates = ParticleSimulation::QInstance().QParticleVisitsAllowUpdate();
-		const int iparticleVisitsExpiredCleanup = ParticleSimulation::QInstance().QParticleVisitsExpiredCleanup();
-		const int ichunkVisits = ParticleSimulation::QInstance().QChunkVisits();
-		const int iBurningParticles = ParticleSimulation::QInstance().QBurningParticles();
+		const int iParticleCount = ACTIVE_SIMULATION::QInstance().QParticleCount();
+		const int iactiveParticles = ACTIVE_SIMULATION::QInstance().QActiveParticleCount();
+		const int iparticleVisitsTotal = ACTIVE_SIMULATION::QInstance().QParticleVisitsTotal();
+		const int iparticleVisitsRedraw = ACTIVE_SIMULATION::QInstance().QParticleVisitsRedraw();
+		const int iparticleVisitsChunkTick = ACTIVE_SIMULATION::QInstance().QParticleVisitsChunkTick();
+		const int iparticleVisitsWakeChunk = ACTIVE_SIMULATION::QInstance().QParticleVisitsWakeChunk();
+		const int iparticleVisitsExpiredCleanup = ACTIVE_SIMULATION::QInstance().QParticleVisitsExpiredCleanup();
+		const int ichunkVisits = ACTIVE_SIMULATION::QInstance().QChunkVisits();
+		const int iBurningParticles = ACTIVE_SIMULATION::QInstance().QBurningParticles();
+		const int iParticleAllocations = ACTIVE_SIMULATION::QInstance().QParticleAllocations();
+		const int iParticleRecycles = ACTIVE_SIMULATION::QInstance().QParticleRecycles();
+		const int iParticleFrees = ACTIVE_SIMULATION::QInstance().QParticleFrees();
+		const int iPoolBlockAllocations = ACTIVE_SIMULATION::QInstance().QPoolBlockAllocations();
+		const int iAllocatedChunks = ACTIVE_SIMULATION::QInstance().QAllocatedChunkCount();
+		const int iResidentChunks = ACTIVE_SIMULATION::QInstance().QResidentChunkCount();
+		const int iPowderTickMicroseconds = ACTIVE_SIMULATION::QInstance().QClassTickMicroseconds(PARTICLE_CLASS::POWDER);
+		const int iLiquidTickMicroseconds = ACTIVE_SIMULATION::QInstance().QClassTickMicroseconds(PARTICLE_CLASS::LIQUID);
+		const int iGasTickMicroseconds = ACTIVE_SIMULATION::QInstance().QClassTickMicroseconds(PARTICLE_CLASS::GAS);
+		const int iSolidTickMicroseconds = ACTIVE_SIMULATION::QInstance().QClassTickMicroseconds(PARTICLE_CLASS::SOLID);
 
 		SET_DEBUG_STAT_TEXT_VAL(FPSCount,							ifps,							"FPS");
 		SET_DEBUG_STAT_TEXT_VAL(FrameMS,							deltaTicks,						"MS");
 		SET_DEBUG_STAT_TEXT_VAL(ActiveParticlesCount,				iactiveParticles,				"Active Particles");
 		SET_DEBUG_STAT_TEXT_VAL(TotalParticlesCount,				iParticleCount,					"Total Particles");
 		SET_DEBUG_STAT_TEXT_VAL(ParticleVisitsCountTotal,			iparticleVisitsTotal,			"Pixel Visits");
-		SET_DEBUG_STAT_TEXT_VAL(ParticleVisitsCountPreChunk,		iparticleVisitsPreChunk,		"Pre-Chunk");
+		SET_DEBUG_STAT_TEXT_VAL(ParticleVisitsCountRedraw,			iparticleVisitsRedraw,			"Redraw");
 		SET_DEBUG_STAT_TEXT_VAL(ParticleVisitsCountChunkTick,		iparticleVisitsChunkTick,		"Chunk Tick");
 		SET_DEBUG_STAT_TEXT_VAL(ParticleVisitsCountWakeChunk,		iparticleVisitsWakeChunk,		"Wake Chunk");
-		SET_DEBUG_STAT_TEXT_VAL(ParticleVisitsCountAllowUpdate,		iparticleVisitsAllowUpdates,	"Allow Updates");
 		SET_DEBUG_STAT_TEXT_VAL(ParticleVisitsCountExpiredCleanup,	iparticleVisitsExpiredCleanup,	"Expired Cleanup");
 		SET_DEBUG_STAT_TEXT_VAL(ChunkVisitsCount,					ichunkVisits,					"Chunk Visits");
 		SET_DEBUG_STAT_TEXT_VAL(BurningParticles,					iBurningParticles,				"Burning Particles");
+		SET_DEBUG_STAT_TEXT_VAL(ParticleAllocations,				iParticleAllocations,			"Allocations");
+		SET_DEBUG_STAT_TEXT_VAL(ParticleRecycles,					iParticleRecycles,				"Recycled Allocations");
+		SET_DEBUG_STAT_TEXT_VAL(ParticleFrees,						iParticleFrees,					"Frees");
+		SET_DEBUG_STAT_TEXT_VAL(PoolBlockAllocations,				iPoolBlockAllocations,			"Pool Blocks");
+		SET_DEBUG_STAT_TEXT_VAL(AllocatedChunks,					iAllocatedChunks,				"Allocated Chunks");
+		SET_DEBUG_STAT_TEXT_VAL(ResidentChunks,						iResidentChunks,				"Resident Chunks");
+		SET_DEBUG_STAT_TEXT_VAL(PowderTickMicroseconds,				iPowderTickMicroseconds,		"us Powders");
+		SET_DEBUG_STAT_TEXT_VAL(LiquidTickMicroseconds,				iLiquidTickMicroseconds,		"us Liquids");
+		SET_DEBUG_STAT_TEXT_VAL(GasTickMicroseconds,				iGasTickMicroseconds,			"us Gases");
+		SET_DEBUG_STAT_TEXT_VAL(SolidTickMicroseconds,				iSolidTickMicroseconds,			"us Solids");
 
 		// ---- RENDER BEGINS ----
 		wWindow.clear();
 
-		// Create our canvas image
-		// We need an sf::Image as that provides the easiest access to an array of pixel data
-		// This single image is then scaled up to fill the screen
-		imCanvas->create(simulationResolution, simulationResolution, SCREEN_CLEAR_COLOUR);
-
 		// TICKS
+		// Loading a snapshot can resize the simulation, in which case the canvas must follow
+		const sf::Vector2u vSimulationSize(ACTIVE_SIMULATION::QInstance().QWidth(), ACTIVE_SIMULATION::QInstance().QHeight());
+		if (imCanvas->getSize() != vSimulationSize)
+		{
+			imCanvas->create(vSimulationSize.x, vSimulationSize.y, COLOR_CLEAR);
+		}
+
 		// MAIN TICK
-		bool bRefreshCanvas = ParticleSimulation::QInstance().Tick(*imCanvas);
+		// Streaming worlds keep the chunks around the mouse resident
+		if (ACTIVE_SIMULATION::QInstance().QStreaming())
+		{
+			const sf::Vector2i vFocus = Painting::WorldToSimulationSpaceCoords(sf::Mouse::getPosition(wWindow));
+			ACTIVE_SIMULATION::QInstance().SetStreamingFocus(vFocus.x, vFocus.y);
+		}
+		bool bRefreshCanvas = ACTIVE_SIMULATION::QInstance().Tick(*imCanvas);
 
 		// UI TICK
 		for (int i = 0; i < static_cast<int>(TOOLBAR_BUTTONS::COUNT); ++i)
@@ -394,23 +450,45 @@ int main()
 			wWindow.draw(ActiveParticlesCount);
 			wWindow.draw(TotalParticlesCount);
 			wWindow.draw(ParticleVisitsCountTotal);
-			wWindow.draw(ParticleVisitsCountPreChunk);
+			wWindow.draw(ParticleVisitsCountRedraw);
 			wWindow.draw(ParticleVisitsCountChunkTick);
 			wWindow.draw(ParticleVisitsCountWakeChunk);
-			wWindow.draw(ParticleVisitsCountAllowUpdate);
 			wWindow.draw(ParticleVisitsCountExpiredCleanup);
 			wWindow.draw(ChunkVisitsCount);
 			wWindow.draw(BurningParticles);
+			wWindow.draw(ParticleAllocations);
+			wWindow.draw(ParticleRecycles);
+			wWindow.draw(ParticleFrees);
+			wWindow.draw(PoolBlockAllocations);
+			wWindow.draw(AllocatedChunks);
+			wWindow.draw(ResidentChunks);
+			wWindow.draw(PowderTickMicroseconds);
+			wWindow.draw(LiquidTickMicroseconds);
+			wWindow.draw(GasTickMicroseconds);
+			wWindow.draw(SolidTickMicroseconds);
 		}
 		// Chunk lines
 		if (DebugToggles::QInstance().bShowChunkBoundaries)
 		{
-			for (int x = 0; x < SCREEN_RESOLUTION; x += (SCREEN_RESOLUTION / chunkCount))
+			const float fCanvasWidth = ACTIVE_SIMULATION::QInstance().QWidth() * CANVAS_SCALE_FACTOR;
+			const float fCanvasHeight = ACTIVE_SIMULATION::QInstance().QHeight() * CANVAS_SCALE_FACTOR;
+			for (int i = 0; i < ACTIVE_SIMULATION::QInstance().QWidth() / chunkSize; ++i)
 			{
+				const float x = i * chunkSize * CANVAS_SCALE_FACTOR;
 				sf::Vertex vLine[2];
 				vLine[0].position = sf::Vector2f(x, 0);
 				vLine[0].color = sf::Color::Red;
-				vLine[1].position = sf::Vector2f(x, SCREEN_RESOLUTION);
+				vLine[1].position = sf::Vector2f(x, fCanvasHeight);
+				vLine[1].color = sf::Color::Red;
+				wWindow.draw(vLine, 2, sf::Lines);
+			}
+			for (int i = 0; i < ACTIVE_SIMULATION::QInstance().QHeight() / chunkSize; ++i)
+			{
+				const float y = i * chunkSize * CANVAS_SCALE_FACTOR;
+				sf::Vertex vLine[2];
+				vLine[0].position = sf::Vector2f(0, y);
+				vLine[0].color = sf::Color::Red;
+				vLine[1].position = sf::Vector2f(fCanvasWidth, y);
 				vLine[1].color = sf::Color::Red;
 				wWindow.draw(vLine, 2, sf::Lines);
 			}
@@ -450,7 +528,7 @@ int main()
 									if (!SimulationSerializer::QInstance().LoadSimulation()) { std::cout << "Failed load\n"; }
 									break;
 								case TOOLBAR_BUTTONS::RESET:
-									ParticleSimulation::QInstance().ResetSimulation();
+									ACTIVE_SIMULATION::QInstance().ResetSimulation();
 									LandingPage::bShowLandingPage = true;
 									break;
 									// Input tools
@@ -562,6 +640,10 @@ int main()
 						case sf::Keyboard::F2:
 							DebugToggles::QInstance().bShowChunkBoundaries = !DebugToggles::QInstance().bShowChunkBoundaries;
 							break;
+						case sf::Keyboard::F3:
+							ACTIVE_SIMULATION::QInstance().SetClassBatching(!ACTIVE_SIMULATION::QInstance().QClassBatching());
+							std::cout << "Batching particles by class: " << (ACTIVE_SIMULATION::QInstance().QClassBatching() ? "on" : "off") << std::endl;
+							break;
 
 
 						case sf::Keyboard::F5:
@@ -589,7 +671,7 @@ int main()
 							break;
 
 						case sf::Keyboard::R:
-							ParticleSimulation::QInstance().ResetSimulation();
+							ACTIVE_SIMULATION::QInstance().ResetSimulation();
 							LandingPage::bShowLandingPage = true;
 							break;
 
@@ -626,11 +708,11 @@ int main()
 					{
 						if (Painting::bIgniting)
 						{
-							ParticleSimulation::QInstance().IgniteParticle(x, y);
+							ACTIVE_SIMULATION::QInstance().IgniteParticle(x, y);
 						}
 						else
 						{
-							ParticleSimulation::QInstance().SpawnParticle(x, y, Painting::pCurrentlyPaintingParticle);
+							ACTIVE_SIMULATION::QInstance().SpawnParticle(x, y, Painting::pCurrentlyPaintingParticle);
 						}
 					}
 				}
@@ -639,11 +721,11 @@ int main()
 			{
 				if (Painting::bIgniting)
 				{
-					ParticleSimulation::QInstance().IgniteParticle(mousePos.x, mousePos.y);
+					ACTIVE_SIMULATION::QInstance().IgniteParticle(mousePos.x, mousePos.y);
 				}
 				else
 				{
-					ParticleSimulation::QInstance().SpawnParticle(mousePos.x, mousePos.y, Painting::pCurrentlyPaintingParticle);
+					ACTIVE_SIMULATION::QInstance().SpawnParticle(mousePos.x, mousePos.y, Painting::pCurrentlyPaintingParticle);
 				}
 			}
 		}
@@ -656,13 +738,13 @@ int main()
 				{
 					for (int y = mousePos.y - (Painting::iBrushSize / 2); y < mousePos.y + (Painting::iBrushSize / 2); ++y)
 					{
-						ParticleSimulation::QInstance().DestroyParticle(x, y);
+						ACTIVE_SIMULATION::QInstance().DestroyParticle(x, y);
 					}
 				}
 			}
 			else
 			{
-				ParticleSimulation::QInstance().DestroyParticle(mousePos.x, mousePos.y);
+				ACTIVE_SIMULATION::QInstance().DestroyParticle(mousePos.x, mousePos.y);
 			}
 		}
 
@@ -0,0 +1,58 @@
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include "BenchmarkPrimitives.h"
+#include "BenchmarkScaling.h"
+#include "BenchmarkScenarios.h"
+
+#define DEFAULT_PRIMITIVE_OPS 1000000
+
+/// <summary>
+/// Benchmark runner for the particle simulation.
+/// Usage: "Tinderbox - Benchmarks" scenarios [tick count] [width height]
+///        "Tinderbox - Benchmarks" primitives [ops per primitive]
+///        "Tinderbox - Benchmarks" scaling [tick count]
+///        "Tinderbox - Benchmarks" layouts [tick count]
+///        "Tinderbox - Benchmarks" orders [tick count]
+/// </summary>
+int main(int argc, char* argv[])
+{
+	const char* sMode = argc > 1 ? argv[1] : "scenarios";
+
+	if (strcmp(sMode, "scenarios") == 0)
+	{
+		if (argc > 4)
+		{
+			ACTIVE_SIMULATION::QInstance().ResizeSimulation(std::atoi(argv[3]), std::atoi(argv[4]));
+		}
+		RunScenarioBenchmarks(argc > 2 ? std::atoi(argv[2]) : 0);
+		return EXIT_SUCCESS;
+	}
+	if (strcmp(sMode, "primitives") == 0)
+	{
+		SimulationPrimitiveBenchmarks().Run(argc > 2 ? std::atoi(argv[2]) : DEFAULT_PRIMITIVE_OPS);
+		return EXIT_SUCCESS;
+	}
+	if (strcmp(sMode, "scaling") == 0)
+	{
+		return RunScalingBenchmarks(argc > 2 ? std::atoi(argv[2]) : 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+	if (strcmp(sMode, "layouts") == 0)
+	{
+		RunLayoutBenchmarks(argc > 2 ? std::atoi(argv[2]) : 0);
+		return EXIT_SUCCESS;
+	}
+	if (strcmp(sMode, "orders") == 0)
+	{
+		RunUpdateOrderBenchmarks(argc > 2 ? std::atoi(argv[2]) : 0);
+		return EXIT_SUCCESS;
+	}
+
+	std::cout << "Usage: " << argv[0] << " scenarios [tick count] [width height]" << std::endl;
+	std::cout << "       " << argv[0] << " primitives [ops per primitive]" << std::endl;
+	std::cout << "       " << argv[0] << " scaling [tick count]" << std::endl;
+	std::cout << "       " << argv[0] << " layouts [tick count]" << std::endl;
+	std::cout << "       " << argv[0] << " orders [tick count]" << std::endl;
+	return EXIT_FAILURE;
+}
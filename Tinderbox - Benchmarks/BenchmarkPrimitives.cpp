@@ -0,0 +1,200 @@
+#include "BenchmarkPrimitives.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+
+#include "ParticleMaterials.h"
+
+#define PRIMITIVE_RANDOM_SEED 4321
+#define PRIMITIVE_BATCH_SIZE 4096			// Operations timed between restores, for primitives that change the simulation
+#define PRIMITIVE_SAMPLE_CELL_COUNT 65536
+
+// The empty density still holds a sparse scattering of particles, so primitives that act on a particle have something to act on
+constexpr float primitiveEmptyDensity = 1.0f / 256.0f;
+
+namespace
+{
+	// Results are accumulated here, so the compiler can't discard the calls being timed
+	volatile long long iBenchmarkSink = 0;
+}
+
+/// <summary>
+/// Runs every primitive at each density, printing a table of ns/op
+/// </summary>
+/// <param name="aiOpsPerPrimitive">Number of calls timed per primitive and density</param>
+void SimulationPrimitiveBenchmarks::Run(int aiOpsPerPrimitive)
+{
+	struct Density
+	{
+		const char* sName;
+		float fDensity;
+	};
+	const Density densities[] = { { "Empty", primitiveEmptyDensity }, { "50%", 0.5f }, { "Packed", 1.0f } };
+
+	srand(PRIMITIVE_RANDOM_SEED);
+	sampleCells.clear();
+	for (int i = 0; i < PRIMITIVE_SAMPLE_CELL_COUNT; ++i)
+	{
+		sampleCells.push_back({ rand() % rSimulation.QWidth(), rand() % rSimulation.QHeight() });
+	}
+
+	printf("\n%-32s %12s %12s %12s\n", "Primitive (ns/op)", densities[0].sName, densities[1].sName, densities[2].sName);
+
+	std::vector<std::string> names;
+	std::vector<std::vector<double>> results;
+	for (const Density& rDensity : densities)
+	{
+		FillSimulation(rDensity.fDensity);
+		std::vector<double> densityResults;
+
+		densityResults.push_back(TimeOps(aiOpsPerPrimitive, false, [this](int i)
+			{
+				const Cell& rCell = sampleCells[i % sampleCells.size()];
+				iBenchmarkSink += rSimulation.IsSpaceOccupied(rCell.x, rCell.y);
+			}));
+
+		densityResults.push_back(TimeOps(aiOpsPerPrimitive, false, [this](int i)
+			{
+				const Cell& rCell = sampleCells[i % sampleCells.size()];
+				iBenchmarkSink += rSimulation.IsParticleOnEdge(rCell.x, rCell.y);
+			}));
+
+		densityResults.push_back(TimeOps(aiOpsPerPrimitive, false, [this](int i)
+			{
+				const Cell& rCell = sampleCells[i % sampleCells.size()];
+				Particle* pParticle = rSimulation.GetParticleFromMap(rSimulation.particleIDMap(rCell.x, rCell.y));
+				const PARTICLE_TYPE eType = pParticle ? static_cast<PARTICLE_TYPE>(pParticle->QType()) : PARTICLE_TYPE::SAND;
+				iBenchmarkSink += rSimulation.GetParticleColor(eType, rCell.x, rCell.y).r;
+			}));
+
+		densityResults.push_back(TimeOps(aiOpsPerPrimitive, false, [this](int i)
+			{
+				Particle* pRequester = rSimulation.GetParticleFromMap(requesterIDs[i % requesterIDs.size()]);
+				const int iTargetY = pRequester->QY() + 1 < rSimulation.QHeight() ? pRequester->QY() + 1 : pRequester->QY() - 1;
+				Particle* pTarget = rSimulation.GetParticleFromMap(rSimulation.particleIDMap(pRequester->QX(), iTargetY));
+				iBenchmarkSink += pTarget && materialRegistry.QCanDisplace(static_cast<PARTICLE_TYPE>(pRequester->QType()), static_cast<PARTICLE_TYPE>(pTarget->QType()));
+			}));
+
+		densityResults.push_back(TimeOps(aiOpsPerPrimitive, false, [this](int i)
+			{
+				Particle* pRequester = rSimulation.GetParticleFromMap(requesterIDs[i % requesterIDs.size()]);
+				int iHitX = pRequester->QX();
+				int iHitY = pRequester->QY();
+				iBenchmarkSink += rSimulation.LineTest(pRequester->QID(), pRequester->QX(), pRequester->QY(), pRequester->QX(), pRequester->QY() + 4, iHitX, iHitY);
+				iBenchmarkSink += iHitX + iHitY;
+			}));
+
+		densityResults.push_back(TimeOps(aiOpsPerPrimitive, true, [this](int i)
+			{
+				Particle* pRequester = rSimulation.GetParticleFromMap(requesterIDs[i % requesterIDs.size()]);
+				const int iTargetX = pRequester->QX() + ((i % 3) - 1);
+				const int iTargetY = pRequester->QY() + 1;
+				if (rSimulation.RequestParticleMove(pRequester->QID(), iTargetX, iTargetY))
+				{
+					// Particles update their own position after a successful move
+					pRequester->SetPosition(iTargetX, iTargetY);
+					++iBenchmarkSink;
+				}
+			}));
+
+		densityResults.push_back(TimeOps(aiOpsPerPrimitive, true, [this](int i)
+			{
+				const Cell& rCell = sampleCells[i % sampleCells.size()];
+				rSimulation.SpawnParticle(rCell.x, rCell.y, PARTICLE_TYPE::SAND);
+			}));
+
+		results.push_back(densityResults);
+	}
+
+	const char* primitiveNames[] = { "IsSpaceOccupied", "IsParticleOnEdge", "GetParticleColor", "QCanDisplace", "LineTest", "RequestParticleMove", "SpawnParticle" };
+	for (int i = 0; i < static_cast<int>(results[0].size()); ++i)
+	{
+		printf("%-32s %12.2f %12.2f %12.2f\n", primitiveNames[i], results[0][i], results[1][i], results[2][i]);
+	}
+}
+
+/// <summary>
+/// Fills the simulation with a random mix of sand, water and rock, with roughly afDensity of the cells occupied
+/// </summary>
+void SimulationPrimitiveBenchmarks::FillSimulation(float afDensity)
+{
+	const PARTICLE_TYPE fillTypes[] = { PARTICLE_TYPE::SAND, PARTICLE_TYPE::SAND, PARTICLE_TYPE::WATER, PARTICLE_TYPE::WATER, PARTICLE_TYPE::ROCK };
+
+	filledSnapshot.cachedParticles.clear();
+	for (int y = 0; y < rSimulation.QHeight(); ++y)
+	{
+		for (int x = 0; x < rSimulation.QWidth(); ++x)
+		{
+			if (rand() < afDensity * RAND_MAX)
+			{
+				ParticleSnapshot snap = ParticleSnapshot();
+				snap.tType = fillTypes[rand() % 5];
+				snap.x = x;
+				snap.y = y;
+				filledSnapshot.cachedParticles.push_back(snap);
+			}
+		}
+	}
+	RestoreSimulation();
+}
+
+/// <summary>
+/// Resets the simulation to the last filled state, silencing the message ResetSimulation prints
+/// </summary>
+void SimulationPrimitiveBenchmarks::RestoreSimulation()
+{
+	std::cout.setstate(std::ios::failbit);
+	rSimulation.ResetSimulation(filledSnapshot);
+	std::cout.clear();
+	CacheRequesters();
+}
+
+/// <summary>
+/// Caches the ID of every particle in the simulation
+/// </summary>
+void SimulationPrimitiveBenchmarks::CacheRequesters()
+{
+	requesterIDs.clear();
+	for (int y = 0; y < rSimulation.QHeight(); ++y)
+	{
+		for (int x = 0; x < rSimulation.QWidth(); ++x)
+		{
+			if (rSimulation.particleIDMap(x, y) != NULL_PARTICLE_ID)
+			{
+				requesterIDs.push_back(rSimulation.particleIDMap(x, y));
+			}
+		}
+	}
+}
+
+/// <summary>
+/// Times a number of calls to a primitive
+/// </summary>
+/// <param name="aiOps">Number of calls to time</param>
+/// <param name="abRestoreBetweenBatches">Whether the simulation should be restored every PRIMITIVE_BATCH_SIZE calls, for primitives that change it. Restoring is not timed.</param>
+/// <param name="afOp">Calls the primitive once, given the index of the call</param>
+/// <returns>Mean time per call, in nanoseconds.</returns>
+template <typename F>
+double SimulationPrimitiveBenchmarks::TimeOps(int aiOps, bool abRestoreBetweenBatches, F afOp)
+{
+	std::chrono::steady_clock::duration tTotal = std::chrono::steady_clock::duration::zero();
+	for (int iBatchStart = 0; iBatchStart < aiOps; iBatchStart += PRIMITIVE_BATCH_SIZE)
+	{
+		const int iBatchEnd = std::min(iBatchStart + PRIMITIVE_BATCH_SIZE, aiOps);
+		const std::chrono::steady_clock::time_point tStart = std::chrono::steady_clock::now();
+		for (int i = iBatchStart; i < iBatchEnd; ++i)
+		{
+			afOp(i);
+		}
+		tTotal += std::chrono::steady_clock::now() - tStart;
+
+		if (abRestoreBetweenBatches)
+		{
+			RestoreSimulation();
+		}
+	}
+	return std::chrono::duration<double, std::nano>(tTotal).count() / aiOps;
+}
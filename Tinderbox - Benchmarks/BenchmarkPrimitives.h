@@ -0,0 +1,36 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "ParticleSimulation.h"
+
+/// <summary>
+/// Microbenchmarks for the per-particle primitives of ParticleSimulation, each measured in isolation at a range of occupancy densities.
+/// Declared a friend of ParticleSimulation, so protected helpers can be timed directly.
+/// </summary>
+class SimulationPrimitiveBenchmarks
+{
+public:
+	SimulationPrimitiveBenchmarks() : rSimulation(ParticleSimulation::QInstance()) {}
+
+	void Run(int aiOpsPerPrimitive);
+
+private:
+	struct Cell
+	{
+		int x, y;
+	};
+
+	void FillSimulation(float afDensity);
+	void RestoreSimulation();
+	void CacheRequesters();
+
+	template <typename F>
+	double TimeOps(int aiOps, bool abRestoreBetweenBatches, F afOp);
+
+	ParticleSimulation& rSimulation;
+	SimulationSnapshot filledSnapshot;
+	std::vector<Cell> sampleCells;		// Random cells, precomputed so the benchmarks don't time the random number generator
+	std::vector<int> requesterIDs;		// IDs of particles in the filled simulation, used by primitives acting on a particle
+};
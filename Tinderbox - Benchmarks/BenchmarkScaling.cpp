@@ -0,0 +1,287 @@
+#include "BenchmarkScaling.h"
+#include "BenchmarkStats.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "ParticleColors.h"
+#include "SimulationEngine.h"
+
+#define SCALING_RANDOM_SEED 1234
+#define SCALING_TICK_COUNT 300
+
+const int scalingGridSizes[] = { 256, 512, 1024, 2048, 4096 };
+
+/// <summary>
+/// A grid layout compared by the layout benchmark
+/// </summary>
+struct BenchmarkLayout
+{
+	const char* sName;
+	GRID_LAYOUT eLayout;
+	int iTileSize;
+};
+
+const BenchmarkLayout benchmarkLayouts[] =
+{
+	{ "Columns", GRID_LAYOUT::COLUMNS, defaultGridTileSize },
+	{ "Tiles 8x8", GRID_LAYOUT::TILES, 8 },
+	{ "Tiles 16x16", GRID_LAYOUT::TILES, 16 },
+	{ "Morton 8x8", GRID_LAYOUT::MORTON_TILES, 8 },
+	{ "Morton 16x16", GRID_LAYOUT::MORTON_TILES, 16 }
+};
+
+/// <summary>
+/// An update order compared by the update order benchmark
+/// </summary>
+struct BenchmarkUpdateOrder
+{
+	const char* sName;
+	bool bClassBatching;
+};
+
+const BenchmarkUpdateOrder benchmarkUpdateOrders[] =
+{
+	{ "Rows", false },
+	{ "Rows + batches", true }
+};
+
+/// <summary>
+/// Builds the scaling scene: a rock floor, a block of sand, a block of water and a burning block of wood.
+/// Every feature is laid out as a fraction of the grid size, so each grid size has the same density.
+/// </summary>
+static void SetupScalingScene(ACTIVE_SIMULATION& arSimulation, int aiGridSize)
+{
+	auto Scale = [aiGridSize](float afFraction) { return static_cast<int>(afFraction * aiGridSize); };
+	auto SpawnRect = [&arSimulation](int aiMinX, int aiMinY, int aiMaxX, int aiMaxY, PARTICLE_TYPE aeParticleType)
+		{
+			for (int y = aiMinY; y < aiMaxY; ++y)
+			{
+				for (int x = aiMinX; x < aiMaxX; ++x)
+				{
+					arSimulation.SpawnParticle(x, y, aeParticleType);
+				}
+			}
+		};
+
+	SpawnRect(0, Scale(0.9f), aiGridSize, aiGridSize, PARTICLE_TYPE::ROCK);
+	SpawnRect(Scale(0.05f), Scale(0.1f), Scale(0.35f), Scale(0.6f), PARTICLE_TYPE::SAND);
+	SpawnRect(Scale(0.4f), Scale(0.1f), Scale(0.7f), Scale(0.5f), PARTICLE_TYPE::WATER);
+	SpawnRect(Scale(0.75f), Scale(0.6f), Scale(0.95f), Scale(0.9f), PARTICLE_TYPE::WOOD);
+	for (int x = Scale(0.75f); x < Scale(0.95f); ++x)
+	{
+		arSimulation.IgniteParticle(x, Scale(0.6f));
+	}
+}
+
+/// <summary>
+/// Resizes the simulation to aiGridSize x aiGridSize, builds the scaling scene, and returns the median time taken to tick it
+/// </summary>
+/// <returns>The median tick time in milliseconds, or -1 if the simulation could not be resized.</returns>
+static double TimeScalingScene(int aiGridSize, int aiThreadCount, int aiTickCount)
+{
+	ACTIVE_SIMULATION& rSimulation = ACTIVE_SIMULATION::QInstance();
+	rSimulation.SetTickPacing(false);
+	rSimulation.SetThreadCount(aiThreadCount);
+	rSimulation.ResizeSimulation(aiGridSize, aiGridSize);
+	if (rSimulation.QWidth() != aiGridSize || rSimulation.QHeight() != aiGridSize)
+	{
+		return -1.0;
+	}
+
+	srand(SCALING_RANDOM_SEED);
+	SetupScalingScene(rSimulation, aiGridSize);
+
+	sf::Image imCanvas;
+	imCanvas.create(rSimulation.QWidth(), rSimulation.QHeight(), COLOR_CLEAR);
+
+	std::vector<double> tickTimes;
+	tickTimes.reserve(aiTickCount);
+	for (int i = 0; i < aiTickCount; ++i)
+	{
+		const std::chrono::steady_clock::time_point tStart = std::chrono::steady_clock::now();
+		rSimulation.Tick(imCanvas);
+		const std::chrono::duration<double, std::milli> tElapsed = std::chrono::steady_clock::now() - tStart;
+		tickTimes.push_back(tElapsed.count());
+	}
+	return Percentile(tickTimes, 50.0);
+}
+
+/// <summary>
+/// Runs the scaling scene at each grid size, over a range of thread counts, printing the tick time, speed-up over one thread, and parallel efficiency of each
+/// </summary>
+/// <param name="aiTickCount">Number of ticks to run each combination for. Defaults to SCALING_TICK_COUNT if 0 or less.</param>
+/// <returns>False, without running anything, if the simulation can't tick on every hardware thread, such as when built without USE_THREADED_CHUNKS.</returns>
+/// <remarks>
+/// Thread counts double from 1 up to the hardware thread count, which is always included.
+/// Grid sizes the simulation can't be resized to are skipped. The simulation is returned to its default size once done.
+/// </remarks>
+bool RunScalingBenchmarks(int aiTickCount)
+{
+#ifndef USE_THREADED_CHUNKS
+	printf("Error: built without USE_THREADED_CHUNKS, so the simulation only ticks on one thread. Thread scaling can't be measured.\n");
+	return false;
+#endif
+
+	const int iTickCount = aiTickCount > 0 ? aiTickCount : SCALING_TICK_COUNT;
+	const int iHardwareThreads = std::thread::hardware_concurrency() > 0 ? static_cast<int>(std::thread::hardware_concurrency()) : 1;
+
+	std::vector<int> threadCounts;
+	for (int iThreads = 1; iThreads < iHardwareThreads; iThreads *= 2)
+	{
+		threadCounts.push_back(iThreads);
+	}
+	threadCounts.push_back(iHardwareThreads);
+
+	// Engines that can't tick on more than one thread would rerun the same single threaded tick for every thread count
+	ACTIVE_SIMULATION::QInstance().SetThreadCount(iHardwareThreads);
+	if (ACTIVE_SIMULATION::QInstance().QThreadCount() != iHardwareThreads)
+	{
+		printf("Error: asked for %d threads, but the simulation ticks on %d. Only the ParticleSimulation engine ticks on more than one thread.\n",
+			iHardwareThreads, ACTIVE_SIMULATION::QInstance().QThreadCount());
+		return false;
+	}
+
+	struct ScalingResult
+	{
+		int iGridSize;
+		int iThreads;
+		double fMedianMS;
+	};
+	std::vector<ScalingResult> results;
+	for (const int iGridSize : scalingGridSizes)
+	{
+		for (const int iThreads : threadCounts)
+		{
+			const double fMedianMS = TimeScalingScene(iGridSize, iThreads, iTickCount);
+			if (fMedianMS >= 0.0)
+			{
+				results.push_back({ iGridSize, iThreads, fMedianMS });
+			}
+		}
+	}
+
+	printf("\n%-10s %8s %10s %10s %11s\n", "Grid", "Threads", "Median ms", "Speed-up", "Efficiency");
+	for (const int iGridSize : scalingGridSizes)
+	{
+		char sGrid[32];
+		snprintf(sGrid, sizeof(sGrid), "%dx%d", iGridSize, iGridSize);
+		double fSingleThreadMS = 0.0;
+		for (const ScalingResult& rResult : results)
+		{
+			if (rResult.iGridSize != iGridSize)
+			{
+				continue;
+			}
+			if (fSingleThreadMS == 0.0)
+			{
+				fSingleThreadMS = rResult.fMedianMS;
+			}
+			const double fSpeedUp = rResult.fMedianMS > 0.0 ? fSingleThreadMS / rResult.fMedianMS : 0.0;
+			printf("%-10s %8d %10.3f %10.2f %10.0f%%\n", sGrid, rResult.iThreads, rResult.fMedianMS, fSpeedUp, (fSpeedUp / rResult.iThreads) * 100.0);
+		}
+		if (fSingleThreadMS == 0.0)
+		{
+			printf("%-10s skipped, the simulation could not be resized to this size\n", sGrid);
+		}
+	}
+	printf("Speed-up is relative to the first row of each grid size, which runs on 1 thread. Efficiency is speed-up per thread.\n");
+
+	ACTIVE_SIMULATION::QInstance().SetThreadCount(iHardwareThreads);
+	ACTIVE_SIMULATION::QInstance().ResizeSimulation(defaultSimulationWidth, defaultSimulationHeight);
+	return true;
+}
+
+/// <summary>
+/// Runs the scaling scene at each grid size with each grid layout, printing the tick time of each and its speed-up over the column layout
+/// </summary>
+/// <param name="aiTickCount">Number of ticks to run each combination for. Defaults to SCALING_TICK_COUNT if 0 or less.</param>
+/// <remarks>Every combination runs on the hardware thread count, or as many threads as the engine can tick on. The simulation is returned to its default size and layout once done.</remarks>
+void RunLayoutBenchmarks(int aiTickCount)
+{
+	const int iTickCount = aiTickCount > 0 ? aiTickCount : SCALING_TICK_COUNT;
+	const int iHardwareThreads = std::thread::hardware_concurrency() > 0 ? static_cast<int>(std::thread::hardware_concurrency()) : 1;
+	ACTIVE_SIMULATION& rSimulation = ACTIVE_SIMULATION::QInstance();
+	rSimulation.SetThreadCount(iHardwareThreads);
+	const int iThreadCount = rSimulation.QThreadCount();
+
+	printf("\n%-10s %-14s %10s %10s\n", "Grid", "Layout", "Median ms", "Speed-up");
+	for (const int iGridSize : scalingGridSizes)
+	{
+		char sGrid[32];
+		snprintf(sGrid, sizeof(sGrid), "%dx%d", iGridSize, iGridSize);
+		double fColumnsMS = 0.0;
+		for (const BenchmarkLayout& rLayout : benchmarkLayouts)
+		{
+			rSimulation.SetGridLayout(rLayout.eLayout, rLayout.iTileSize);
+			const double fMedianMS = TimeScalingScene(iGridSize, iThreadCount, iTickCount);
+			if (fMedianMS < 0.0)
+			{
+				printf("%-10s skipped, the simulation could not be resized to this size\n", sGrid);
+				break;
+			}
+			if (fColumnsMS == 0.0)
+			{
+				fColumnsMS = fMedianMS;
+			}
+			printf("%-10s %-14s %10.3f %10.2f\n", sGrid, rLayout.sName, fMedianMS, fMedianMS > 0.0 ? fColumnsMS / fMedianMS : 0.0);
+		}
+	}
+	printf("Speed-up is relative to the column layout, the first row of each grid size.\n");
+
+	rSimulation.SetGridLayout(GRID_LAYOUT::COLUMNS);
+	rSimulation.ResizeSimulation(defaultSimulationWidth, defaultSimulationHeight);
+}
+
+/// <summary>
+/// Runs the scaling scene at each grid size with and without batching by class, printing the tick time of each and its speed-up over the first order timed
+/// </summary>
+/// <param name="aiTickCount">Number of ticks to run each combination for. Defaults to SCALING_TICK_COUNT if 0 or less.</param>
+/// <remarks>
+/// Every combination runs on the hardware thread count, or as many threads as the engine can tick on.
+/// Combinations the engine doesn't support are skipped. The simulation is returned to its size and batching from before once done.
+/// </remarks>
+void RunUpdateOrderBenchmarks(int aiTickCount)
+{
+	const int iTickCount = aiTickCount > 0 ? aiTickCount : SCALING_TICK_COUNT;
+	const int iHardwareThreads = std::thread::hardware_concurrency() > 0 ? static_cast<int>(std::thread::hardware_concurrency()) : 1;
+	ACTIVE_SIMULATION& rSimulation = ACTIVE_SIMULATION::QInstance();
+	rSimulation.SetThreadCount(iHardwareThreads);
+	const int iThreadCount = rSimulation.QThreadCount();
+	const bool bStartClassBatching = rSimulation.QClassBatching();
+
+	printf("\n%-10s %-22s %10s %10s\n", "Grid", "Order", "Median ms", "Speed-up");
+	for (const int iGridSize : scalingGridSizes)
+	{
+		char sGrid[32];
+		snprintf(sGrid, sizeof(sGrid), "%dx%d", iGridSize, iGridSize);
+		double fRowsMS = 0.0;
+		for (const BenchmarkUpdateOrder& rOrder : benchmarkUpdateOrders)
+		{
+			rSimulation.SetClassBatching(rOrder.bClassBatching);
+			if (rSimulation.QClassBatching() != rOrder.bClassBatching)
+			{
+				printf("%-10s %-22s skipped, not supported by this engine\n", sGrid, rOrder.sName);
+				continue;
+			}
+			const double fMedianMS = TimeScalingScene(iGridSize, iThreadCount, iTickCount);
+			if (fMedianMS < 0.0)
+			{
+				printf("%-10s skipped, the simulation could not be resized to this size\n", sGrid);
+				break;
+			}
+			if (fRowsMS == 0.0)
+			{
+				fRowsMS = fMedianMS;
+			}
+			printf("%-10s %-22s %10.3f %10.2f\n", sGrid, rOrder.sName, fMedianMS, fMedianMS > 0.0 ? fRowsMS / fMedianMS : 0.0);
+		}
+	}
+	printf("Speed-up is relative to the first row timed for each grid size.\n");
+
+	rSimulation.SetClassBatching(bStartClassBatching);
+	rSimulation.ResizeSimulation(defaultSimulationWidth, defaultSimulationHeight);
+}
@@ -0,0 +1,5 @@
+#pragma once
+
+bool RunScalingBenchmarks(int aiTickCount);
+void RunLayoutBenchmarks(int aiTickCount);
+void RunUpdateOrderBenchmarks(int aiTickCount);
@@ -0,0 +1,182 @@
+#include "BenchmarkScenarios.h"
+#include "BenchmarkStats.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+
+#include "ParticleColors.h"
+
+#define BENCHMARK_RANDOM_SEED 1234
+#define SCENARIO_TICK_COUNT 600
+
+// Scenes are laid out as fractions of the simulation, so they keep the same density at any size
+#define SCALE_X(FRACTION) static_cast<int>((FRACTION) * arSimulation.QWidth())
+#define SCALE_Y(FRACTION) static_cast<int>((FRACTION) * arSimulation.QHeight())
+
+/// <summary>
+/// Spawns a rectangle of particles, from (aiMinX, aiMinY) up to but not including (aiMaxX, aiMaxY)
+/// </summary>
+static void SpawnRect(ACTIVE_SIMULATION& arSimulation, int aiMinX, int aiMinY, int aiMaxX, int aiMaxY, PARTICLE_TYPE aeParticleType)
+{
+	for (int y = aiMinY; y < aiMaxY; ++y)
+	{
+		for (int x = aiMinX; x < aiMaxX; ++x)
+		{
+			arSimulation.SpawnParticle(x, y, aeParticleType);
+		}
+	}
+}
+
+/// <summary>
+/// Builds the fixed set of benchmark scenes
+/// </summary>
+std::vector<BenchmarkScenario> CreateBenchmarkScenarios()
+{
+	std::vector<BenchmarkScenario> scenarios;
+
+	// A tall block of sand collapsing onto an empty floor
+	scenarios.push_back({ "Sand avalanche", SCENARIO_TICK_COUNT, [](ACTIVE_SIMULATION& arSimulation)
+		{
+			SpawnRect(arSimulation, SCALE_X(0.25f), 0, SCALE_X(0.75f), SCALE_Y(0.75f), PARTICLE_TYPE::SAND);
+		}, nullptr });
+
+	// A row of trees, with wooden trunks and leaf canopies, lit from one end
+	scenarios.push_back({ "Forest fire", SCENARIO_TICK_COUNT, [](ACTIVE_SIMULATION& arSimulation)
+		{
+			const int iGround = arSimulation.QHeight() - 1;
+			const int iTreeSpacing = SCALE_X(0.0625f);
+			for (int x = iTreeSpacing / 2; x < arSimulation.QWidth(); x += iTreeSpacing)
+			{
+				SpawnRect(arSimulation, x - 1, iGround - SCALE_Y(0.25f), x + 2, iGround + 1, PARTICLE_TYPE::WOOD);
+				SpawnRect(arSimulation, x - (iTreeSpacing / 2), iGround - SCALE_Y(0.4f), x + (iTreeSpacing / 2), iGround - SCALE_Y(0.25f), PARTICLE_TYPE::LEAVES);
+			}
+			arSimulation.IgniteParticle(iTreeSpacing / 2, iGround);
+		}, nullptr });
+
+	// A reservoir of water released over uneven rock
+	scenarios.push_back({ "Water flood", SCENARIO_TICK_COUNT, [](ACTIVE_SIMULATION& arSimulation)
+		{
+			for (int x = 0; x < arSimulation.QWidth(); ++x)
+			{
+				const int iHeight = SCALE_Y(0.1f) + static_cast<int>(SCALE_Y(0.08f) * std::sin(x * 0.05f));
+				SpawnRect(arSimulation, x, arSimulation.QHeight() - iHeight, x + 1, arSimulation.QHeight(), PARTICLE_TYPE::ROCK);
+			}
+			SpawnRect(arSimulation, 0, 0, SCALE_X(0.3f), SCALE_Y(0.6f), PARTICLE_TYPE::WATER);
+		}, nullptr });
+
+	// Pools of lava and water poured into each other, producing steam and rock
+	scenarios.push_back({ "Lava meets water", SCENARIO_TICK_COUNT, [](ACTIVE_SIMULATION& arSimulation)
+		{
+			SpawnRect(arSimulation, 0, SCALE_Y(0.5f), SCALE_X(0.45f), arSimulation.QHeight(), PARTICLE_TYPE::LAVA);
+			SpawnRect(arSimulation, SCALE_X(0.55f), SCALE_Y(0.5f), arSimulation.QWidth(), arSimulation.QHeight(), PARTICLE_TYPE::WATER);
+		}, nullptr });
+
+	// Emitters at the bottom of the simulation releasing a constant column of smoke and steam
+	scenarios.push_back({ "Smoke/steam column", SCENARIO_TICK_COUNT, [](ACTIVE_SIMULATION&) {},
+		[](ACTIVE_SIMULATION& arSimulation, int)
+		{
+			const int iEmitterWidth = SCALE_X(0.1f);
+			const int iEmitterY = arSimulation.QHeight() - 1;
+			for (int x = 0; x < iEmitterWidth; ++x)
+			{
+				arSimulation.SpawnParticle(SCALE_X(0.3f) + x, iEmitterY, PARTICLE_TYPE::SMOKE);
+				arSimulation.SpawnParticle(SCALE_X(0.6f) + x, iEmitterY, PARTICLE_TYPE::STEAM);
+			}
+		} });
+
+	return scenarios;
+}
+
+/// <summary>
+/// Clears the simulation, builds a scenario, and runs it for its tick count
+/// </summary>
+/// <remarks>The random seed is reset before every scenario, so each run of a scenario is identical.</remarks>
+BenchmarkScenarioResult RunBenchmarkScenario(const BenchmarkScenario& arScenario)
+{
+	ACTIVE_SIMULATION& rSimulation = ACTIVE_SIMULATION::QInstance();
+	rSimulation.SetTickPacing(false);
+	rSimulation.ResetSimulation(SimulationSnapshot());
+
+	srand(BENCHMARK_RANDOM_SEED);
+	arScenario.fSetup(rSimulation);
+
+	sf::Image imCanvas;
+	imCanvas.create(rSimulation.QWidth(), rSimulation.QHeight(), COLOR_CLEAR);
+
+	BenchmarkScenarioResult result;
+	result.sName = arScenario.sName;
+	result.iTickCount = arScenario.iTickCount;
+
+	// Allocation counters cover everything since the start of the last full tick, so reading them just before each tick counts the
+	// previous tick along with any emitter spawns since, and reading them once more after the last tick counts that tick. Setup spawns are excluded.
+	int iSetupAllocations = rSimulation.QParticleAllocations();
+	int iSetupFrees = rSimulation.QParticleFrees();
+
+	std::vector<double> tickTimes;
+	tickTimes.reserve(arScenario.iTickCount);
+	for (int i = 0; i < arScenario.iTickCount; ++i)
+	{
+		if (arScenario.fPerTick)
+		{
+			arScenario.fPerTick(rSimulation, i);
+		}
+		result.iAllocations += rSimulation.QParticleAllocations() - iSetupAllocations;
+		result.iFrees += rSimulation.QParticleFrees() - iSetupFrees;
+		iSetupAllocations = 0;
+		iSetupFrees = 0;
+
+		const std::chrono::steady_clock::time_point tStart = std::chrono::steady_clock::now();
+		rSimulation.Tick(imCanvas);
+		const std::chrono::duration<double, std::milli> tElapsed = std::chrono::steady_clock::now() - tStart;
+		tickTimes.push_back(tElapsed.count());
+
+		result.fMeanPixelVisits += rSimulation.QParticleVisitsTotal();
+		result.fMeanChunkTickVisits += rSimulation.QParticleVisitsChunkTick();
+		result.fMeanRedrawVisits += rSimulation.QParticleVisitsRedraw();
+		result.fMeanWakeVisits += rSimulation.QParticleVisitsWakeChunk();
+		result.fMeanChunkVisits += rSimulation.QChunkVisits();
+	}
+	result.iAllocations += rSimulation.QParticleAllocations() - iSetupAllocations;
+	result.iFrees += rSimulation.QParticleFrees() - iSetupFrees;
+
+	const double fTickCount = arScenario.iTickCount > 0 ? arScenario.iTickCount : 1;
+	result.fMedianTickMS = Percentile(tickTimes, 50.0);
+	result.fP99TickMS = Percentile(tickTimes, 99.0);
+	result.fMeanPixelVisits /= fTickCount;
+	result.fMeanChunkTickVisits /= fTickCount;
+	result.fMeanRedrawVisits /= fTickCount;
+	result.fMeanWakeVisits /= fTickCount;
+	result.fMeanChunkVisits /= fTickCount;
+	result.iFinalParticles = rSimulation.QParticleCount();
+	return result;
+}
+
+/// <summary>
+/// Runs every benchmark scenario, printing a table of results
+/// </summary>
+/// <param name="aiTickCountOverride">If greater than 0, replaces each scenario's tick count</param>
+void RunScenarioBenchmarks(int aiTickCountOverride)
+{
+	std::vector<BenchmarkScenarioResult> results;
+	for (BenchmarkScenario& rScenario : CreateBenchmarkScenarios())
+	{
+		if (aiTickCountOverride > 0)
+		{
+			rScenario.iTickCount = aiTickCountOverride;
+		}
+		results.push_back(RunBenchmarkScenario(rScenario));
+	}
+
+	printf("\n%-20s %7s %10s %10s %10s %10s %12s %12s %10s %10s %8s %10s\n",
+		"Scenario", "Ticks", "Median ms", "P99 ms", "Allocs", "Frees", "Pixel vis.", "Chunk tick", "Redraw", "Wake", "Chunks", "Particles");
+	for (const BenchmarkScenarioResult& rResult : results)
+	{
+		printf("%-20s %7d %10.3f %10.3f %10lld %10lld %12.0f %12.0f %10.0f %10.0f %8.1f %10d\n",
+			rResult.sName.c_str(), rResult.iTickCount, rResult.fMedianTickMS, rResult.fP99TickMS, rResult.iAllocations, rResult.iFrees,
+			rResult.fMeanPixelVisits, rResult.fMeanChunkTickVisits, rResult.fMeanRedrawVisits, rResult.fMeanWakeVisits, rResult.fMeanChunkVisits, rResult.iFinalParticles);
+	}
+	printf("Visit counts are means per tick.\n");
+}
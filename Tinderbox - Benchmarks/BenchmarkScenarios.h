@@ -0,0 +1,41 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "SimulationEngine.h"
+
+/// <summary>
+/// A reproducible scene, built through the simulation's own spawning API
+/// </summary>
+struct BenchmarkScenario
+{
+	std::string sName;
+	int iTickCount;
+	std::function<void(ACTIVE_SIMULATION&)> fSetup;
+	std::function<void(ACTIVE_SIMULATION&, int)> fPerTick;	// Optional, called before each tick with the tick index. Used by scenes with emitters.
+};
+
+/// <summary>
+/// Results of running a single scenario
+/// </summary>
+struct BenchmarkScenarioResult
+{
+	std::string sName;
+	int iTickCount = 0;
+	double fMedianTickMS = 0.0;
+	double fP99TickMS = 0.0;
+	long long iAllocations = 0;
+	long long iFrees = 0;
+	double fMeanPixelVisits = 0.0;
+	double fMeanChunkTickVisits = 0.0;
+	double fMeanRedrawVisits = 0.0;
+	double fMeanWakeVisits = 0.0;
+	double fMeanChunkVisits = 0.0;
+	int iFinalParticles = 0;
+};
+
+std::vector<BenchmarkScenario> CreateBenchmarkScenarios();
+BenchmarkScenarioResult RunBenchmarkScenario(const BenchmarkScenario& arScenario);
+void RunScenarioBenchmarks(int aiTickCountOverride);
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+/// <summary>
+/// Returns the value at a given percentile of a set of samples, using the nearest-rank method
+/// </summary>
+/// <param name="avSamples">Samples to rank. Taken by value, as they need sorting.</param>
+/// <param name="afPercentile">Percentile to sample, between 0 and 100</param>
+inline double Percentile(std::vector<double> avSamples, double afPercentile)
+{
+	if (avSamples.empty())
+	{
+		return 0.0;
+	}
+
+	std::sort(avSamples.begin(), avSamples.end());
+	const int iRank = static_cast<int>((afPercentile / 100.0) * (avSamples.size() - 1) + 0.5);
+	return avSamples[std::min<int>(iRank, static_cast<int>(avSamples.size()) - 1)];
+}
@@ -0,0 +1,95 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include <SFML/Graphics.hpp>
+
+#include "ParticleColors.h"
+#include "SimulationEngine.h"
+#include "SimulationSerializer.h"
+
+#define DEFAULT_TICK_COUNT 1000
+
+/// <summary>
+/// Headless simulation runner. Loads a simulation snapshot, and runs a fixed number of ticks as fast as possible with no window or frame pacing.
+/// Usage: "Tinderbox - Headless" <snapshot file> [tick count] [sparse|stream]
+/// </summary>
+int main(int argc, char* argv[])
+{
+	if (argc < 2)
+	{
+		std::cout << "Usage: " << argv[0] << " <snapshot file> [tick count] [sparse|stream]" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	const std::string sSnapshotPath = argv[1];
+	const int iTickCount = argc > 2 ? std::atoi(argv[2]) : DEFAULT_TICK_COUNT;
+	if (iTickCount <= 0)
+	{
+		std::cout << "Invalid tick count (" << argv[2] << ")" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	// Loading keeps the storage mode of the simulation, so sparse storage and streaming have to be chosen first
+	const std::string sStorage = argc > 3 ? argv[3] : "";
+	if (sStorage == "sparse" || sStorage == "stream")
+	{
+		ACTIVE_SIMULATION::QInstance().ResizeSimulation(ACTIVE_SIMULATION::QInstance().QWidth(), ACTIVE_SIMULATION::QInstance().QHeight(), true);
+	}
+	if (sStorage == "stream")
+	{
+		ACTIVE_SIMULATION::QInstance().EnableStreaming("ChunkStore");
+	}
+	// Engines without chunks log and ignore both, and their results would be passed off as the mode asked for
+	if ((sStorage == "sparse" && !ACTIVE_SIMULATION::QInstance().QSparse()) || (sStorage == "stream" && !ACTIVE_SIMULATION::QInstance().QStreaming()))
+	{
+		std::cout << "This simulation engine doesn't support " << sStorage << " storage" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	if (!SimulationSerializer::QInstance().LoadSimulation(sSnapshotPath))
+	{
+		std::cout << "Failed to load snapshot (" << sSnapshotPath << ")" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	ACTIVE_SIMULATION& rSimulation = ACTIVE_SIMULATION::QInstance();
+
+	// The canvas is still drawn to, but never displayed. Snapshots carry their world size, so it is only known once loaded.
+	sf::Image imCanvas;
+	imCanvas.create(rSimulation.QWidth(), rSimulation.QHeight(), COLOR_CLEAR);
+
+	rSimulation.SetTickPacing(false);
+
+	long long iPixelVisits = 0;
+	const std::chrono::steady_clock::time_point tStart = std::chrono::steady_clock::now();
+	for (int i = 0; i < iTickCount; ++i)
+	{
+		rSimulation.Tick(imCanvas);
+		iPixelVisits += rSimulation.QParticleVisitsTotal();
+	}
+	const std::chrono::duration<double> tElapsed = std::chrono::steady_clock::now() - tStart;
+
+	const double fSeconds = tElapsed.count() > 0.0 ? tElapsed.count() : 1e-9;
+	const double fTicksPerSecond = iTickCount / fSeconds;
+	// Every cell of the world, once per tick, whether or not its chunk was awake. Pixel visits count the cells actually processed.
+	const double fWorldCellsPerSecond = fTicksPerSecond * rSimulation.QWidth() * rSimulation.QHeight();
+
+	std::cout << "World size:         " << rSimulation.QWidth() << "x" << rSimulation.QHeight() << (rSimulation.QSparse() ? " (sparse)" : "") << "\n";
+	std::cout << "Allocated chunks:   " << rSimulation.QAllocatedChunkCount() << "\n";
+	if (rSimulation.QStreaming())
+	{
+		std::cout << "Resident chunks:    " << rSimulation.QResidentChunkCount() << "\n";
+	}
+	std::cout << "Ticks:              " << iTickCount << "\n";
+	std::cout << "Elapsed (s):        " << fSeconds << "\n";
+	std::cout << "Ticks/sec:          " << fTicksPerSecond << "\n";
+	std::cout << "World cells/sec:    " << fWorldCellsPerSecond << "\n";
+	std::cout << "Pixel visits/sec:   " << iPixelVisits / fSeconds << "\n";
+	std::cout << "Particles:          " << rSimulation.QParticleCount() << "\n";
+	std::cout << "Active particles:   " << rSimulation.QActiveParticleCount() << "\n";
+	std::cout << "Burning particles:  " << rSimulation.QBurningParticles() << std::endl;
+
+	return EXIT_SUCCESS;
+}